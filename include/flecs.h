@@ -34,6 +34,9 @@
 
 #define ECS_HANDLE_NIL (0)
 
+/* Alignment of table columns in bytes when a SIMD width is set */
+#define ECS_COLUMN_ALIGNMENT (64)
+
 /** Function return values */
 typedef enum EcsResult {
     EcsOk,
@@ -94,6 +97,20 @@ typedef struct EcsReference {
     EcsType component;
 } EcsReference;
 
+/** Cached reference to a component of an entity. A reference stores where a
+ * component was found, so that repeated lookups of the same component do not
+ * have to search for it again. Members are managed by ecs_get_ref and should
+ * not be modified by the application. Initialize a reference to zero. */
+typedef struct EcsRef {
+    EcsEntity entity;    /* entity of reference */
+    EcsType component;   /* component of reference */
+    EcsType type_id;     /* table of entity when reference was resolved */
+    uint32_t version;    /* version of table when reference was resolved */
+    EcsType src_type_id; /* table of prefab if component is from prefab */
+    uint32_t src_version; /* version of prefab table */
+    void *ptr;           /* resolved pointer to component */
+} EcsRef;
+
 /** Data passed to system action callback, used for iterating entities */
 typedef struct EcsRows {
     EcsWorld *world;     /* current world */
@@ -110,16 +127,47 @@ typedef struct EcsRows {
     void *param;         /* userdata passed to on-demand system */
     float delta_time;    /* time elapsed since last frame */
     uint32_t index_offset; /* number of rows processed by system in this frame */
+    uint32_t changed;    /* bitset of columns changed since last invocation */
+    uint64_t group;      /* group of current table (see ecs_set_group_by) */
     uint32_t count;      /* System should process count rows */
     uint32_t begin;     /* System should start iteration from begin */
     uint32_t end;        /* Convenience variable that holds begin + count */
+    uint32_t padded_end; /* end rounded up to SIMD width (see ecs_set_simd_width) */
     EcsEntity interrupted_by; /* when set, system execution is interrupted */
 } EcsRows;
 
+/** A query stores the tables that match a signature */
+typedef struct EcsQuery EcsQuery;
+
+/** Iterator over the tables of a query. The rows member describes the table
+ * that the iterator is at, and can be used with the ecs_column functions. */
+typedef struct EcsQueryIter {
+    EcsQuery *query;     /* query being iterated */
+    uint32_t index;      /* index of next table to evaluate */
+    EcsRows rows;        /* rows of current table */
+} EcsQueryIter;
+
 /** System action callback type */
 typedef void (*EcsSystemAction)(
     EcsRows *data);
 
+/** Compare callback type used for sorting. Returns a negative value if the
+ * first entity should be ordered before the second, a positive value if it
+ * should be ordered after the second, and zero if the order does not matter. */
+typedef int (*EcsCompareAction)(
+    EcsEntity e1,
+    void *ptr1,
+    EcsEntity e2,
+    void *ptr2);
+
+/** Group callback type. Returns the group of a table, given its type and the
+ * array of entities (of type EcsEntity) in the type. */
+typedef uint64_t (*EcsGroupByAction)(
+    EcsWorld *world,
+    EcsType type,
+    EcsArray *entities,
+    void *ctx);
+
 /** Initialization function signature of modules */
 typedef void (*EcsModuleInitAction)(
     EcsWorld *world,
@@ -383,6 +431,69 @@ void ecs_set_target_fps(
     EcsWorld *world,
     float fps);
 
+/** Defer table activation to the next frame.
+ * Systems only iterate tables that are active, which are tables that have at
+ * least one entity. By default, a table is activated and deactivated for all of
+ * its systems as soon as its first entity is added or its last entity is
+ * removed. For tables that are frequently emptied and filled, for example when
+ * an application creates short-lived entities, this can be expensive.
+ *
+ * When deferred activation is enabled, these transitions are only recorded,
+ * and applied once at the start of the next call to ecs_progress. Tables that
+ * are emptied and filled again before that time never notify their systems.
+ * Systems skip active tables that are empty.
+ *
+ * This function should not be called while processing an iteration.
+ *
+ * @param world The world.
+ * @param enabled Whether table activation should be deferred.
+ */
+FLECS_EXPORT
+void ecs_set_deferred_activation(
+    EcsWorld *world,
+    bool enabled);
+
+/** Keep emptied tables active for a number of frames.
+ * This setting only has an effect when deferred activation is enabled. A table
+ * that is emptied remains active for the specified number of calls to
+ * ecs_progress. If the table is filled again within that period, its systems
+ * are not notified at all. The default is zero.
+ *
+ * @param world The world.
+ * @param frames The number of frames an empty table remains active.
+ */
+FLECS_EXPORT
+void ecs_set_deactivation_delay(
+    EcsWorld *world,
+    uint32_t frames);
+
+/** Allocate table columns for SIMD processing.
+ * When a width is set, column buffers are aligned to ECS_COLUMN_ALIGNMENT
+ * bytes, and can always hold a multiple of width rows. Systems can then process
+ * rows from begin up to padded_end (see EcsRows) in blocks of width rows,
+ * without a scalar loop for the remaining rows. Rows between end and
+ * padded_end do not belong to an entity. They may be read and written, but
+ * their values are undefined.
+ *
+ * Jobs of multithreaded systems start on a multiple of width rows, so that the
+ * first row passed to a system is aligned to width * component size bytes (up
+ * to ECS_COLUMN_ALIGNMENT). This does not apply to sorted systems, which
+ * iterate slices of tables, or to systems invoked with an offset.
+ *
+ * Existing columns are reallocated when the width is set. Setting the width
+ * to zero only applies to columns that are allocated afterwards.
+ *
+ * This function should not be called while processing an iteration.
+ *
+ * @param world The world.
+ * @param width The SIMD width in rows, a power of two no larger than
+ *     ECS_COLUMN_ALIGNMENT. Zero disables padding.
+ */
+FLECS_EXPORT
+void ecs_set_simd_width(
+    EcsWorld *world,
+    uint32_t width);
+
 /** Get last used delta time from world */
 FLECS_EXPORT
 float ecs_get_delta_time(
@@ -552,6 +663,36 @@ EcsEntity _ecs_new_w_count(
 #define ecs_new_w_count(world, type, count, handles_out)\
     _ecs_new_w_count(world, T##type, count, handles_out)
 
+/** Create a new set of entities and initialize their components.
+ * This operation creates the number of specified entities, and copies the
+ * component values from the provided buffers into the new entities. The data
+ * parameter contains one buffer per component in the type, in the order in
+ * which the components appear in the type (which is ordered by component
+ * handle). Each buffer contains count values. A buffer may be NULL, in which
+ * case the component is not initialized.
+ *
+ * Buffers are copied with a single memcpy per component, and OnSet systems are
+ * invoked once for all new entities.
+ *
+ * @param world The world.
+ * @param type Handle to a component or type.
+ * @param count The number of entities to create.
+ * @param data An array with a buffer for each component in the type.
+ * @param handles_out An array which contains the handles of the new entities.
+ * @returns The handle to the first created entity.
+ */
+FLECS_EXPORT
+EcsEntity _ecs_new_w_data(
+    EcsWorld *world,
+    EcsType type,
+    uint32_t count,
+    void **data,
+    EcsEntity *handles_out);
+
+/* Macro to ensure you don't accidentally pass a non-type into the function */
+#define ecs_new_w_data(world, type, count, data, handles_out)\
+    _ecs_new_w_data(world, T##type, count, data, handles_out)
+
 /** Create new entity with same components as specified entity.
  * This operation creates a new entity which has the same components as the
  * specified entity. This includes prefabs and entity-components (entities to
@@ -579,9 +720,10 @@ EcsEntity ecs_clone(
  * expensive operation.
  *
  * After this operation the handle will be invalidated and should no longer be
- * used. Handles are not recycled, which implies a finite number of new / delete
- * operations. In the current implementation that number is 2^64 - 1, which
- * should keep code running until the sun runs out of fuel. Possibly longer.
+ * used. The id of the entity is recycled by a subsequent ecs_new, with an
+ * increased generation in the upper 32 bits of the handle. This ensures that
+ * the old handle does not alias the new entity, which can be tested with
+ * ecs_is_alive. When in progress, the id is recycled after the stage is merged.
  *
  * The only post condition for this function is that no entity with the
  * specified handle will exist after the operation. If a handle is provided to
@@ -596,6 +738,27 @@ void ecs_delete(
     EcsWorld *world,
     EcsEntity entity);
 
+/** Delete all entities that have the specified type.
+ * This operation deletes all entities of which the type contains all of the
+ * components in the provided type. Instead of deleting entities one by one,
+ * this operation clears the tables that match the type at once. OnRemove
+ * systems are invoked once per table, for all entities in the table.
+ *
+ * When in progress, the entities are deleted one by one, as tables cannot be
+ * modified while they are being iterated.
+ *
+ * @time-complexity: O(t)
+ * @param world The world.
+ * @param type The type that entities to delete must have.
+ */
+FLECS_EXPORT
+void _ecs_delete_w_filter(
+    EcsWorld *world,
+    EcsType type);
+
+#define ecs_delete_w_filter(world, type)\
+    _ecs_delete_w_filter(world, T##type)
+
 /** Add a type to an entity */
 FLECS_EXPORT
 EcsResult _ecs_add(
@@ -618,6 +781,47 @@ EcsResult _ecs_remove(
 #define ecs_remove(world, entity, type)\
     _ecs_remove(world, entity, T##type)
 
+/** Add a type to all entities that have the specified filter type.
+ * This operation adds a type to all entities of which the type contains all of
+ * the components in the filter. Instead of moving entities one by one, all
+ * entities of a matching table are moved to the destination table at once.
+ * OnAdd systems are invoked once per table.
+ *
+ * When in progress, the type is added to the entities one by one, as tables
+ * cannot be modified while they are being iterated.
+ *
+ * @time-complexity: O(t)
+ * @param world The world.
+ * @param type The type to add.
+ * @param filter The type that entities must have.
+ */
+FLECS_EXPORT
+void _ecs_add_w_filter(
+    EcsWorld *world,
+    EcsType type,
+    EcsType filter);
+
+#define ecs_add_w_filter(world, type, filter)\
+    _ecs_add_w_filter(world, T##type, T##filter)
+
+/** Remove a type from all entities that have the specified filter type.
+ * This operation is the counterpart of ecs_add_w_filter. OnRemove systems are
+ * invoked once per table.
+ *
+ * @time-complexity: O(t)
+ * @param world The world.
+ * @param type The type to remove.
+ * @param filter The type that entities must have.
+ */
+FLECS_EXPORT
+void _ecs_remove_w_filter(
+    EcsWorld *world,
+    EcsType type,
+    EcsType filter);
+
+#define ecs_remove_w_filter(world, type, filter)\
+    _ecs_remove_w_filter(world, T##type, T##filter)
+
 /** Adopt a child entity by a parent */
 FLECS_EXPORT
 EcsResult ecs_adopt(
@@ -667,6 +871,32 @@ void* _ecs_get_ptr(
 #define ecs_get(world, entity, type)\
   (*(type*)_ecs_get_ptr(world, entity, T##type))
 
+/** Get pointer to a component using a cached reference.
+ * This operation is equivalent to ecs_get_ptr, but caches where the component
+ * was found in the provided reference. Subsequent calls with the same entity
+ * and component return the cached pointer, as long as the entity has not moved
+ * to another table and the table columns have not been reallocated.
+ *
+ * When in progress, this operation does not use the cache, as the component may
+ * be stored in a stage.
+ *
+ * @time-complexity: O(1)
+ * @param world The world.
+ * @param ref A reference, initialized to zero before first use.
+ * @param entity Handle to the entity from which to obtain the component data.
+ * @param component The component to retrieve the data for.
+ * @returns A pointer to the data, or NULL of the component was not found.
+ */
+FLECS_EXPORT
+void* _ecs_get_ref(
+    EcsWorld *world,
+    EcsRef *ref,
+    EcsEntity entity,
+    EcsType type);
+
+#define ecs_get_ref(world, ref, entity, type)\
+    _ecs_get_ref(world, ref, entity, T##type)
+
 #define ecs_get_singleton(world, type)\
     (*(type*)_ecs_get_ptr(world, 0, T##type))
 
@@ -787,6 +1017,22 @@ bool ecs_empty(
     EcsWorld *world,
     EcsEntity entity);
 
+/** Return if the entity handle is alive.
+ * This returns whether the entity handle has been returned by ecs_new (or its
+ * variants) and has not been deleted with ecs_delete since. Handles of deleted
+ * entities are never alive, even after their id is recycled. An entity that is
+ * deleted while in progress remains alive until the stage is merged.
+ *
+ * @time-complexity: O(1)
+ * @param world The world.
+ * @param entity The entity handle.
+ * @returns true if alive, false if not alive.
+ */
+FLECS_EXPORT
+bool ecs_is_alive(
+    EcsWorld *world,
+    EcsEntity entity);
+
 /** Get type of entity */
 FLECS_EXPORT
 EcsType ecs_typeid(
@@ -821,11 +1067,12 @@ const char* ecs_id(
 
 /** Lookup an entity by id.
  * This operation is a convenient way to lookup entities by string identifier
- * that have the EcsId component. It is recommended to cache the result of this
- * function, as the function must iterates over all entities and all components
- * in an entity.
+ * that have the EcsId component. Entities are found through an index that is
+ * updated when the EcsId component is set with ecs_set or copied with
+ * ecs_clone. Ids that are assigned by writing directly to the component are
+ * not found.
  *
- * @time-complexity: O(t * c)
+ * @time-complexity: O(1)
  * @param world The world.
  * @param id The id to lookup.
  * @returns The entity handle if found, or ECS_HANDLE_NIL if not found.
@@ -835,6 +1082,39 @@ EcsEntity ecs_lookup(
     EcsWorld *world,
     const char *id);
 
+/** Lookup a child entity by id.
+ * This operation is equivalent to ecs_lookup, but only returns entities that
+ * are children of the specified parent. If parent is 0, any entity with the
+ * specified id is returned.
+ *
+ * @time-complexity: O(1)
+ * @param world The world.
+ * @param parent The parent of the entity to lookup.
+ * @param id The id to lookup.
+ * @returns The entity handle if found, or ECS_HANDLE_NIL if not found.
+ */
+FLECS_EXPORT
+EcsEntity ecs_lookup_child(
+    EcsWorld *world,
+    EcsEntity parent,
+    const char *id);
+
+/** Lookup an entity by path.
+ * A path contains the ids of an entity and its parents, separated by a dot,
+ * as in "parent.child". The first element of the path is looked up with
+ * ecs_lookup, every subsequent element is looked up as a child of the entity
+ * found for the previous element.
+ *
+ * @time-complexity: O(d)
+ * @param world The world.
+ * @param path The path to lookup.
+ * @returns The entity handle if found, or ECS_HANDLE_NIL if not found.
+ */
+FLECS_EXPORT
+EcsEntity ecs_lookup_path(
+    EcsWorld *world,
+    const char *path);
+
 
 /* -- Component API -- */
 
@@ -1076,6 +1356,92 @@ void ecs_set_period(
     EcsEntity system,
     float period);
 
+/** Skip tables of which the inputs did not change.
+ * When enabled, a system only processes tables in which at least one column
+ * that it reads changed since the last time the system ran. See
+ * ecs_column_changed for when a column is considered changed.
+ *
+ * This operation is only valid on column systems. An application may only
+ * change this setting outside ecs_progress.
+ *
+ * @param world The world.
+ * @param system The system.
+ * @param enabled Whether unchanged tables should be skipped.
+ */
+FLECS_EXPORT
+void ecs_set_skip_unchanged(
+    EcsWorld *world,
+    EcsEntity system,
+    bool enabled);
+
+/** Iterate the entities of a system in sorted order.
+ * When a system has an order, its action is invoked with the entities of its
+ * tables in the order specified by the compare function. The compare function
+ * receives the entities and pointers to the specified component. The component
+ * must be one of the columns of the system. If the column is optional and a
+ * table does not have the component, NULL is passed. If the component is 
+ * shared, all entities of a table receive the same pointer.
+ *
+ * Entities are sorted within their tables, after which the tables are merged.
+ * The action is invoked once for every range of sorted entities that is stored
+ * in the same table, so rows->begin and rows->end may denote a subset of the
+ * table. Tables are only sorted again when entities are added or removed, or
+ * when the component changes (see ecs_column_changed). Prefix the column with
+ * [in] if the system does not write it, so that it does not need to be sorted
+ * after each run. Sorting changes the order in which other systems encounter
+ * entities in the same table.
+ *
+ * Passing NULL for the compare function removes the order.
+ *
+ * This operation is only valid on column systems. An application may only
+ * change this setting outside ecs_progress.
+ *
+ * @param world The world.
+ * @param system The system.
+ * @param component The component to order by.
+ * @param compare The compare function.
+ */
+FLECS_EXPORT
+void _ecs_set_order_by(
+    EcsWorld *world,
+    EcsEntity system,
+    EcsType component,
+    EcsCompareAction compare);
+
+#define ecs_set_order_by(world, system, component, compare)\
+    _ecs_set_order_by(world, system, T##component, compare)
+
+/** Iterate the tables of a system grouped by a key.
+ * The group function is invoked once for every table that is matched with the
+ * system, and returns a key for the table, like the id of a spatial cell or of
+ * a container. Containers are in the type of the table, and can be found by
+ * testing which entities in the type have EcsContainer. Tables are iterated in
+ * the order of their keys, so that tables of the same group are iterated one
+ * after another. The key of the table that is being iterated is available in
+ * rows->group, which lets a system skip the tables of groups it is not
+ * interested in without testing entities.
+ *
+ * If the system also has an order (see ecs_set_order_by), entities are first
+ * ordered by group, then by the compare function.
+ *
+ * The key of a table is computed when it is matched, and when the group
+ * function is set. Passing NULL for the group function removes the grouping.
+ *
+ * This operation is only valid on column systems. An application may only
+ * change this setting outside ecs_progress.
+ *
+ * @param world The world.
+ * @param system The system.
+ * @param group_by The group function.
+ * @param ctx Context passed to the group function.
+ */
+FLECS_EXPORT
+void ecs_set_group_by(
+    EcsWorld *world,
+    EcsEntity system,
+    EcsGroupByAction group_by,
+    void *ctx);
+
 /** Returns the enabled status for a system / entity.
  * This operation will return whether a system is enabled or disabled. Currently
  * only systems can be enabled or disabled, but this operation does not fail
@@ -1298,6 +1664,155 @@ EcsType _ecs_column_type(
 #define ecs_column_type_test(rows, column)\
         _ecs_column_type(rows, column, true)
 
+/** Test if a column changed since the system last ran.
+ * A column changes when a component is set with ecs_set, when staged values
+ * are merged, when entities are added to or removed from the table, and when a
+ * system that writes the column runs. Column 0 changes only when entities are
+ * added or removed.
+ *
+ * Systems write all columns they match, unless a column is prefixed with an
+ * access modifier in the system signature:
+ *
+ * ECS_SYSTEM(world, Transform, EcsOnFrame, [in] Position, [out] Matrix);
+ *
+ * Columns marked with [in] are only read, and do not cause other systems to
+ * see a change. Columns marked with [out] are only written, and are not taken
+ * into account when a system skips unchanged tables. [inout] is the default.
+ *
+ * Changes made by writing to a pointer obtained with ecs_get_ptr are not
+ * detected. For systems with more than 31 columns, all columns are always
+ * reported as changed.
+ *
+ * @param rows Pointer to the rows object passed into the system callback.
+ * @param column An index identifying the column.
+ * @return true if the column changed, false if it did not.
+ */
+FLECS_EXPORT
+bool ecs_column_changed(
+    EcsRows *rows,
+    uint32_t column);
+
+/* -- Query API -- */
+
+/** Create a query.
+ * A query matches tables with a signature in the same way as a column system,
+ * and is kept up to date when new tables are created. Unlike a system, a query
+ * does not have an entity or an action. Instead, an application iterates the
+ * matched tables with ecs_query_iter and ecs_query_next:
+ *
+ * EcsQuery *q = ecs_query_new(world, "Position, Velocity");
+ *
+ * EcsQueryIter it = ecs_query_iter(world, q);
+ * while (ecs_query_next(&it)) {
+ *     Position *p = ecs_column(&it.rows, Position, 1);
+ *     Velocity *v = ecs_column(&it.rows, Velocity, 2);
+ *     for (int i = it.rows.begin; i < it.rows.end; i ++) {
+ *         p[i].x += v[i].x;
+ *         p[i].y += v[i].y;
+ *     }
+ * }
+ *
+ * Signatures of queries cannot contain SYSTEM columns. Queries that have not
+ * been freed when the world is deleted are freed by ecs_fini.
+ *
+ * An application may only create queries outside ecs_progress.
+ *
+ * @time-complexity: O(t)
+ * @param world The world.
+ * @param sig The signature that specifies the components to match.
+ * @returns The new query.
+ */
+FLECS_EXPORT
+EcsQuery* ecs_query_new(
+    EcsWorld *world,
+    const char *sig);
+
+/** Free a query.
+ *
+ * @param world The world.
+ * @param query The query to free.
+ */
+FLECS_EXPORT
+void ecs_query_free(
+    EcsWorld *world,
+    EcsQuery *query);
+
+/** Iterate the entities of a query in sorted order.
+ * This operation is equivalent to ecs_set_order_by, but for queries. Tables
+ * are sorted when an iterator is created.
+ *
+ * @param world The world.
+ * @param query The query.
+ * @param component The component to order by.
+ * @param compare The compare function.
+ */
+FLECS_EXPORT
+void _ecs_query_order_by(
+    EcsWorld *world,
+    EcsQuery *query,
+    EcsType component,
+    EcsCompareAction compare);
+
+#define ecs_query_order_by(world, query, component, compare)\
+    _ecs_query_order_by(world, query, T##component, compare)
+
+/** Iterate the tables of a query grouped by a key.
+ * This operation is equivalent to ecs_set_group_by, but for queries. Groups of
+ * a query can be skipped with ecs_query_skip_group.
+ *
+ * @param world The world.
+ * @param query The query.
+ * @param group_by The group function.
+ * @param ctx Context passed to the group function.
+ */
+FLECS_EXPORT
+void ecs_query_group_by(
+    EcsWorld *world,
+    EcsQuery *query,
+    EcsGroupByAction group_by,
+    void *ctx);
+
+/** Create an iterator for a query.
+ * The iterator does not point to a table until ecs_query_next is called. Empty
+ * tables are skipped. If the query has an order or is grouped, tables are
+ * sorted first. Iterators of the same query share the storage for
+ * pointers to shared components, so the rows of a query with shared columns
+ * are only valid until the next call to ecs_query_next on any of its
+ * iterators.
+ *
+ * @param world The world.
+ * @param query The query to iterate.
+ * @returns An iterator positioned before the first table.
+ */
+FLECS_EXPORT
+EcsQueryIter ecs_query_iter(
+    EcsWorld *world,
+    EcsQuery *query);
+
+/** Advance a query iterator to the next non-empty table.
+ * The rows member of the iterator is updated with the entities and columns of
+ * the table. If the query has an order, the iterator advances to the next range
+ * of sorted entities instead. Change detection is not available for queries, and
+ * ecs_column_changed always returns true for query rows.
+ *
+ * @param iter The iterator.
+ * @returns true if the iterator points to a table, false if there are no more
+ *          tables.
+ */
+FLECS_EXPORT
+bool ecs_query_next(
+    EcsQueryIter *iter);
+
+/** Skip the remaining tables of the current group.
+ * After this operation, ecs_query_next advances to the first table of the next
+ * group. This operation is only useful for queries with a group function.
+ *
+ * @param iter The iterator.
+ */
+FLECS_EXPORT
+void ecs_query_skip_group(
+    EcsQueryIter *iter);
+
 /* -- Error handling & error codes -- */
 
 /** Throw an error */
@@ -1363,6 +1878,7 @@ void _ecs_assert(
 #define ECS_UNRESOLVED_IDENTIFIER (21)
 #define ECS_OUT_OF_RANGE (22)
 #define ECS_COLUMN_IS_NOT_SET (23)
+#define ECS_INVALID_WHILE_ITERATING (24)
 /* -- Convenience macro's -- */
 
 /** Wrapper around ecs_new_entity. */ 
@@ -18,13 +18,74 @@ void ecs_merge_entity(
 /* Notify row system of entity (identified by row_index) */
 bool ecs_notify(
     EcsWorld *world,
-    EcsMap *systems,
+    EcsSystemKind kind,
     EcsType type_id,
     EcsTable *table,
     EcsTableColumn *table_columns,
     int32_t offset,
     int32_t limit);
 
+/* Get component pointer of reference, only update the reference if allowed */
+void* ecs_get_ref_ptr(
+    EcsWorld *world,
+    EcsRef *ref,
+    bool update);
+
+/* -- Entity index API -- */
+
+/* Create new entity index */
+EcsEntityIndex* ecs_entity_index_new(void);
+
+/* Free entity index */
+void ecs_entity_index_free(
+    EcsEntityIndex *index);
+
+/* Get row for entity. Returns an empty row if entity is not in index */
+EcsRow ecs_entity_index_get(
+    EcsEntityIndex *index,
+    EcsEntity entity);
+
+/* Set row for entity */
+void ecs_entity_index_set(
+    EcsEntityIndex *index,
+    EcsEntity entity,
+    EcsRow row);
+
+/* Remove entity from index */
+void ecs_entity_index_remove(
+    EcsEntityIndex *index,
+    EcsEntity entity);
+
+/* Test whether the generation of entity matches the generation in index */
+bool ecs_entity_index_is_alive(
+    EcsEntityIndex *index,
+    EcsEntity entity);
+
+/* Remove entity from index and add its id with a new generation to free list */
+void ecs_entity_index_delete(
+    EcsEntityIndex *index,
+    EcsEntity entity);
+
+/* Take an id from the free list. Returns 0 if there are no free ids. */
+EcsEntity ecs_entity_index_recycle(
+    EcsEntityIndex *index);
+
+/* Return number of entities in index */
+uint32_t ecs_entity_index_count(
+    EcsEntityIndex *index);
+
+/* Preallocate pages for a range of entities */
+void ecs_entity_index_set_size(
+    EcsEntityIndex *index,
+    EcsEntity first,
+    uint32_t count);
+
+/* Get memory used by entity index */
+void ecs_entity_index_memory(
+    EcsEntityIndex *index,
+    uint32_t *allocd,
+    uint32_t *used);
+
 /* -- World API -- */
 
 /* Get (or create) table from type */
@@ -40,6 +101,19 @@ void ecs_world_activate_system(
     EcsSystemKind kind,
     bool active);
 
+/* Add new system to the array for its kind, or to the inactive array */
+void ecs_world_add_system(
+    EcsWorld *world,
+    EcsEntity system,
+    EcsSystemKind kind,
+    bool active);
+
+/* Register id of entity in name index */
+void ecs_world_register_name(
+    EcsWorld *world,
+    EcsEntity entity,
+    const char *id);
+
 /* Get current thread-specific stage */
 EcsStage *ecs_get_stage(
     EcsWorld **world_ptr);
@@ -63,6 +137,41 @@ void ecs_stage_merge(
 
 /* -- Type utility API -- */
 
+/* Initialize type registry */
+void ecs_type_init_registry(
+    EcsWorld *world);
+
+/* Free type registry */
+void ecs_type_free_registry(
+    EcsWorld *world);
+
+/* Get record of registered type */
+EcsTypeRecord* ecs_type_get_record(
+    EcsWorld *world,
+    EcsType type_id);
+
+/* Get prefab of type (0 if type has no prefab) */
+EcsEntity ecs_type_get_prefab(
+    EcsWorld *world,
+    EcsType type_id);
+
+/* Get prefab that owns inherited component (0 if component is not inherited) */
+EcsEntity ecs_type_get_prefab_owner(
+    EcsWorld *world,
+    EcsType type_id,
+    EcsEntity component);
+
+/* Test if type is the type of a prefab */
+bool ecs_type_is_prefab(
+    EcsWorld *world,
+    EcsType type_id);
+
+/* Get array with row systems of specified kind that match type */
+EcsArray** ecs_type_get_row_systems(
+    EcsWorld *world,
+    EcsType type_id,
+    EcsSystemKind kind);
+
 /* Get type from entity handle (component, type, prefab) */
 EcsType ecs_type_from_handle(
     EcsWorld *world,
@@ -149,6 +258,10 @@ EcsTableColumn *ecs_table_get_columns(
     EcsStage *stage,
     EcsArray *type);
 
+/* Apply deferred table activations */
+void ecs_table_activate_dirty(
+    EcsWorld *world);
+
 /* Initialize table with component size (used during bootstrap) */
 EcsResult ecs_table_init_w_size(
     EcsWorld *world,
@@ -161,6 +274,15 @@ void ecs_table_register_system(
     EcsTable *table,
     EcsEntity system);    
 
+/* Build index that finds columns by component in constant time */
+void ecs_table_init_column_index(
+    EcsTable *table);
+
+/* Get position of component in table type, -1 if not found */
+int16_t ecs_table_column_index(
+    EcsTable *table,
+    EcsEntity component);
+
 /* Insert row into table (or stage) */
 uint32_t ecs_table_insert(
     EcsWorld *world,
@@ -176,11 +298,46 @@ uint32_t ecs_table_grow(
     uint32_t count,
     EcsEntity first_entity);
 
+/* Compute plan for moving rows from one table to another */
+EcsMovePlan* ecs_table_new_move_plan(
+    EcsWorld *world,
+    EcsTable *src_table,
+    EcsTable *dst_table);
+
+/* Get cached plan for moving rows from one table to another. Returns NULL if
+ * the cache cannot be used because worker threads are running. */
+EcsMovePlan* ecs_table_get_move_plan(
+    EcsWorld *world,
+    EcsTable *src_table,
+    EcsTable *dst_table);
+
+/* Copy a range of rows between tables (or stages) using a move plan */
+void ecs_table_copy_w_plan(
+    EcsMovePlan *plan,
+    EcsTableColumn *dst_columns,
+    uint32_t dst_index,
+    EcsTableColumn *src_columns,
+    uint32_t src_index,
+    uint32_t count);
+
+/* Move all rows of a table to another table, returns index of first row or
+ * -1 if the destination table could not grow */
+uint32_t ecs_table_move_all(
+    EcsWorld *world,
+    EcsTable *dst_table,
+    EcsTable *src_table);
+
 /* Dimension array to have n rows (doesn't add entities) */
 int16_t ecs_table_dim(
+    EcsWorld *world,
     EcsTable *table,
     uint32_t count);
 
+/* Reallocate columns of table with the alignment and padding of the world */
+void ecs_table_realign(
+    EcsWorld *world,
+    EcsTable *table);
+
 /* Return number of entities in table */
 uint64_t ecs_table_count(
     EcsTable *table);
@@ -193,12 +350,31 @@ uint32_t ecs_table_row_size(
 uint32_t ecs_table_rows_dimensioned(
     EcsTable *table);    
 
+/* Get destination type for adding type to table (uses cached edges) */
+EcsType ecs_table_traverse_add(
+    EcsWorld *world,
+    EcsStage *stage,
+    EcsTable *table,
+    EcsType to_add);
+
+/* Get destination type for removing type from table (uses cached edges) */
+EcsType ecs_table_traverse_remove(
+    EcsWorld *world,
+    EcsStage *stage,
+    EcsTable *table,
+    EcsType to_remove);
+
 /* Delete row from table */
 void ecs_table_delete(
     EcsWorld *world,
     EcsTable *table,
     uint32_t index);
 
+/* Delete all rows from table */
+void ecs_table_clear(
+    EcsWorld *world,
+    EcsTable *table);
+
 /* Get row from table (or stage) */
 void* ecs_table_get(
     EcsTable *table,
@@ -215,6 +391,13 @@ void ecs_table_deinit(
     EcsWorld *world,
     EcsTable *table);
 
+/* Sort rows of table on column */
+void ecs_table_sort(
+    EcsWorld *world,
+    EcsTable *table,
+    int32_t column,
+    EcsCompareAction compare);
+
 /* Free table */
 void ecs_table_free(
     EcsWorld *world,
@@ -236,18 +419,39 @@ EcsEntity ecs_new_col_system(
     const char *sig,
     EcsSystemAction action);
 
-/* Notify column system of a new table, which initiates system-table matching */
-void ecs_col_system_notify_of_table(
+/* Notify column systems and queries of a new table, which initiates
+ * system-table matching */
+void ecs_notify_col_systems_of_table(
     EcsWorld *world,
-    EcsEntity system,
     EcsTable *table);
 
-/* Notify row system of a new type, which initiates system-type matching */
-void ecs_row_system_notify_of_type(
+/* Get row systems of kind that are triggered by the components of a type. If
+ * the systems could not be cached with the type, the caller must free them. */
+EcsArray* ecs_row_systems_for_type(
     EcsWorld *world,
-    EcsStage *stage,
-    EcsEntity system,
-    EcsType type);
+    EcsType type_id,
+    EcsSystemKind kind,
+    bool *is_temp);
+
+/* Free data of column system */
+void ecs_col_system_free(
+    EcsColSystem *system_data);
+
+/* Order tables of column system by group, and sort tables that changed since
+ * they were last sorted */
+void ecs_col_system_sort_tables(
+    EcsWorld *world,
+    EcsEntity system);
+
+/* Update cached pointers of references of column system */
+void ecs_col_system_resolve_refs(
+    EcsWorld *world,
+    EcsEntity system);
+
+/* Compute changed columns of tables, and mark columns written by system */
+void ecs_col_system_track_changes(
+    EcsWorld *world,
+    EcsEntity system);
 
 /* Activate table for system (happens if table goes from empty to not empty) */
 void ecs_system_activate_table(
@@ -266,7 +470,7 @@ void ecs_run_task(
 bool ecs_notify_row_system(
     EcsWorld *world,
     EcsEntity system,
-    EcsArray *type,
+    EcsTable *table,
     EcsTableColumn *table_columns,
     uint32_t offset,
     uint32_t limit);
@@ -276,6 +480,7 @@ EcsResult ecs_parse_component_action(
     EcsWorld *world,
     EcsSystemExprElemKind elem_kind,
     EcsSystemExprOperKind oper_kind,
+    EcsSystemExprInOutKind inout_kind,
     const char *component_id,
     const char *source_id,
     void *data);
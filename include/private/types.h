@@ -21,6 +21,17 @@
 #define ECS_TABLE_INITIAL_ROW_COUNT (0)
 #define ECS_SYSTEM_INITIAL_TABLE_COUNT (0)
 #define ECS_MAX_JOBS_PER_WORKER (16)
+#define ECS_TYPE_PAGE_SIZE (512)
+#define ECS_MAX_TYPE_PAGES (2048)
+#define ECS_ENTITY_PAGE_SIZE (4096)
+#define ECS_TYPE_SIGNATURE_WORDS (4)
+#define ECS_TYPE_SIGNATURE_EXACT (192)
+
+/* The lower 32 bits of an entity handle contain the id, the upper 32 bits
+ * contain the generation of the id, which is increased each time the id is
+ * recycled. */
+#define ECS_ENTITY_MASK ((uint64_t)0xFFFFFFFF)
+#define ECS_GENERATION(entity) ((uint32_t)((entity) >> 32))
 
 #define ECS_WORLD_MAGIC (0x65637377)
 #define ECS_THREAD_MAGIC (0x65637374)
@@ -58,11 +69,19 @@ typedef enum EcsSystemExprOperKind {
     EcsOperLast = 4
 } EcsSystemExprOperKind;
 
+/** Type describing how a system accesses a column ([in], [out], [inout]) */
+typedef enum EcsSystemExprInOutKind {
+    EcsInOut = 0,
+    EcsIn = 1,
+    EcsOut = 2
+} EcsSystemExprInOutKind;
+
 /** Callback used by the system signature expression parser */
 typedef EcsResult (*ecs_parse_action)(
     EcsWorld *world,
     EcsSystemExprElemKind elem_kind,
     EcsSystemExprOperKind oper_kind,
+    EcsSystemExprInOutKind inout_kind,
     const char *component,
     const char *source,
     void *ctx);
@@ -71,6 +90,7 @@ typedef EcsResult (*ecs_parse_action)(
 typedef struct EcsSystemColumn {
     EcsSystemExprElemKind kind;       /* Element kind (Entity, Component) */
     EcsSystemExprOperKind oper_kind;  /* Operator kind (AND, OR, NOT) */
+    EcsSystemExprInOutKind inout_kind; /* Is column read, written or both */
     union {
         EcsType type;             /* Used for OR operator */
         EcsEntity component;      /* Used for AND operator */
@@ -95,6 +115,7 @@ typedef struct EcsSystem {
     EcsType and_from_system;   /* Used to auto-add components to system */
     EcsSystemKind kind;        /* Kind of system */
     float time_spent;          /* Time spent on running system */
+    uint32_t order;            /* Creation sequence, orders systems */
     bool enabled;              /* Is system enabled or not */
 } EcsSystem;
 
@@ -127,7 +148,10 @@ typedef struct EcsSystem {
  * The 'refs' array contains elements of type 'EcsRef', and stores references
  * to external entities. References can vary per table, but not per entity/row,
  * as prefabs / containers are part of the entity type, which in turn 
- * identifies the table in which the entity is stored.
+ * identifies the table in which the entity is stored. The 'ref_cache' array
+ * stores where the component of each reference was last found, so that
+ * references only have to be resolved again when the referenced entity moves
+ * to another table, or when the table columns are reallocated.
  * 
  * The 'period' and 'time_passed' members are used for periodic systems. An
  * application may specify that a system should only run at a specific interval, 
@@ -144,13 +168,45 @@ typedef struct EcsColSystem {
     EcsArray *jobs;            /* Jobs for this system */
     EcsArray *tables;          /* Table index + refs index + column offsets */
     EcsArray *refs;            /* Columns that point to other entities */
+    EcsArray *ref_cache;       /* Resolved pointers of refs, same index */
+    EcsMap *table_index;       /* Position of table in (inactive) tables */
     EcsArrayParams table_params; /* Parameters for tables array */
     EcsArrayParams component_params; /* Parameters for components array */
     EcsArrayParams ref_params; /* Parameters for tables array */
+    EcsArrayParams ref_cache_params; /* Parameters for ref_cache array */
+    EcsType last_table;        /* Last table evaluated by table creation */
     float period;              /* Minimum period inbetween system invocations */
     float time_passed;         /* Time passed since last invocation */
+    uint32_t changed_since;    /* World change version at previous run */
+    uint32_t last_run;         /* World change version at last run */
+    uint32_t in_columns;       /* Bitset of columns that are read */
+    uint32_t out_columns;      /* Bitset of columns that are written */
+    bool skip_unchanged;       /* Skip tables of which no inputs changed */
+    EcsCompareAction compare;  /* Compare function for sorted iteration */
+    uint32_t sort_column;      /* Column to sort on (0 if not sorted) */
+    EcsArray *table_slices;    /* Sorted ranges of rows in tables */
+    bool sort_dirty;           /* Did the set of active tables change */
+    EcsGroupByAction group_by; /* Computes group of matched tables */
+    void *group_by_ctx;        /* Context passed to group_by */
+    bool group_dirty;          /* Are active tables out of group order */
 } EcsColSystem;
 
+/** A table slice is a range of rows in one of the tables of a sorted system.
+ * The slices of a system together contain all rows in sorted order. */
+typedef struct EcsTableSlice {
+    uint32_t table;            /* Index of table in system tables array */
+    uint32_t begin;            /* First row of slice */
+    uint32_t count;            /* Number of rows in slice */
+} EcsTableSlice;
+
+/** A query stores the same data as a column system, without a system entity.
+ * Queries are not registered with tables, so their tables are never moved to
+ * the inactive list. Empty tables are skipped while iterating instead. */
+struct EcsQuery {
+    EcsColSystem system_data;  /* Matched tables, columns and references */
+    void **ref_ptrs;           /* Resolved references of the current table */
+};
+
 /** A row system is a system that is ran on 1..n entities for which a certain 
  * operation has been invoked. The system kind determines on what kind of
  * operation the row system is invoked. Example operations are ecs_add,
@@ -163,31 +219,94 @@ typedef struct EcsRowSystem {
 
 /* -- Private types -- */
 
+/** A type record stores an interned type. Type ids are handed out
+ * sequentially, and are used as index in the type registry, which is why data
+ * that is stored per type can be stored in the record itself, rather than in
+ * a separate map. The hash of a type is only used to find whether a type has
+ * already been registered. Records with the same hash form a list that is
+ * linked through the 'next' member.
+ *
+ * The signature is a bitset that has a bit set for each component in the type.
+ * Components with an id below ECS_TYPE_SIGNATURE_EXACT map to their own bit,
+ * components with higher ids (such as parent entities) are hashed to one of
+ * the remaining bits, which makes that part of the signature a bloom filter. */
+typedef struct EcsTypeRecord {
+    EcsArray *components;         /* Sorted array with component handles */
+    EcsEntity prefab;             /* Prefab of type (0 if type has no prefab) */
+    EcsArray *add_systems;        /* OnAdd row systems that match type */
+    EcsArray *remove_systems;     /* OnRemove row systems that match type */
+    EcsArray *set_systems;        /* OnSet row systems that match type */
+    uint32_t trigger_version;     /* Trigger version of world for row systems */
+    EcsMap *move_plans;           /* Move plans to other types, by type id */
+    EcsMap *prefab_owners;        /* Owning prefab of inherited components */
+    uint32_t prefab_version;      /* Prefab version of world for prefab_owners */
+    uint64_t signature[ECS_TYPE_SIGNATURE_WORDS]; /* Bitset of components */
+    bool is_exact;                /* Signature has no hashed components */
+    uint32_t hash;                /* Hash of component handles */
+    EcsType next;                 /* Next type with the same hash */
+} EcsTypeRecord;
+
 /** A table column describes a single column in a table (archetype) */
 typedef struct EcsTableColumn {
     EcsArray *data;               /* Column data */
+    uint32_t version;             /* World change version of last write */
     uint16_t size;                /* Column size (saves component lookups) */
 } EcsTableColumn;
 
+/** A move plan column describes which column of a source table is copied to
+ * which column of a destination table when moving rows between tables. */
+typedef struct EcsMovePlanColumn {
+    uint16_t src;                 /* Column index in source table */
+    uint16_t dst;                 /* Column index in destination table */
+    uint16_t size;                /* Component size */
+} EcsMovePlanColumn;
+
+/** A move plan lists the columns that two table types have in common. Plans
+ * are computed once for each pair of types, so that moving rows does not have
+ * to merge the component lists of the two types. */
+typedef struct EcsMovePlan {
+    uint32_t count;               /* Number of columns to copy */
+    EcsMovePlanColumn columns[];  /* Columns to copy */
+} EcsMovePlan;
+
 /** A table is the Flecs equivalent of an archetype. Tables store all entities
  * with a specific set of components. Tables are automatically created when an
  * entity has a set of components not previously observed before. When a new
- * table is created, it is automatically matched with existing column systems */
+ * table is created, it is automatically matched with existing column systems.
+ *
+ * Tables form a graph where the edges are the types that are added to or
+ * removed from the table type. The edges are discovered the first time an
+ * entity moves from one table to another, after which adding or removing the
+ * same type only requires a lookup in the add_edges or remove_edges map. */
 typedef struct EcsTable {
-    EcsArray *type;               /* Reference to type_index entry */
+    EcsArray *type;               /* Reference to type registry entry */
     EcsTableColumn *columns;      /* Columns storing components of array */
     EcsArray *frame_systems;      /* Frame systems matched with table */
-    EcsType type_id;              /* Identifies table type in type_index */
+    EcsMap *add_edges;            /* Destination types when adding a type */
+    EcsMap *remove_edges;         /* Destination types when removing a type */
+    int16_t *column_index;        /* Positions in type, by component hash */
+    uint16_t column_index_mask;   /* Number of column index slots - 1 */
+    uint32_t version;             /* Changes when rows move or reallocate */
+    uint32_t empty_frames;        /* Frames an empty table has been active */
+    EcsType type_id;              /* Identifies table type in type registry */
+    bool is_active;               /* Is table active for its systems */
+    bool is_dirty;                /* Is table in world::dirty_tables */
  } EcsTable;
  
 /** The EcsRow struct is a 64-bit value that describes in which table
  * (identified by a type_id) is stored, at which index. Entries in the 
- * world::entity_index are of type EcsRow. */
+ * world::entity_index and stage::entity_index are of type EcsRow. Because type ids are dense and a
+ * table is stored in the tables array at the index of its type id, the type_id
+ * directly locates the table of an entity. */
 typedef struct EcsRow {
-    EcsType type_id;              /* Identifies a type (and table) in world */
+    EcsType type_id;              /* Identifies a type and index of table */
     uint32_t index;               /* Index of the entity in its table */
 } EcsRow;
 
+/** The entity index of the main stage. Entities are stored in pages that are
+ * directly indexed by entity id, as opposed to the hash maps used by stages. */
+typedef struct EcsEntityIndex EcsEntityIndex;
+
 /** Supporting type that internal functions pass around to ensure that data
  * related to an entity is only looked up once. */
 typedef struct EcsEntityInfo {
@@ -206,15 +325,14 @@ typedef struct EcsEntityInfo {
 typedef struct EcsStage {
     /* If this is not main stage, 
      * changes to the entity index 
-     * are buffered here */
+     * are buffered here. The main
+     * stage uses world::entity_index */
     EcsMap *entity_index;        /* Entity lookup table for (table, row) */
 
-    /* If this is not a thread
-     * stage, these are the same
-     * as the main stage */
-    EcsMap *table_index;         /* Index for table stage */
-    EcsArray *tables;            /* Tables created while >1 threads running */
-    EcsMap *type_index;          /* Types created while >1 threads running */
+    /* If this is not the main
+     * stage, this contains tables
+     * created while in progress */
+    EcsArray *tables;            /* Tables, stored at index of type id */
 
     
     /* These occur only in
@@ -222,13 +340,13 @@ typedef struct EcsStage {
      * not on the main stage */
     EcsMap *data_stage;          /* Arrays with staged component values */
     EcsMap *remove_merge;        /* All removed components before merge */
+    EcsArray *delete_stage;      /* Entities deleted while in progress */
 } EcsStage;
 
 /** A type describing a unit of work to be executed by a worker thread. */ 
 typedef struct EcsJob {
     EcsEntity system;             /* System handle */
     EcsColSystem *system_data;    /* System to run */
-    uint32_t table_index;         /* Current SystemTable */
     uint32_t offset;         /* Start index in row chunk */
     uint32_t limit;           /* Total number of rows to process */
 } EcsJob;
@@ -266,6 +384,10 @@ struct EcsWorld {
     EcsArray *on_store_systems;   /* Systems executed at end of frame */
     EcsArray *on_demand_systems;  /* On demand systems */
     EcsArray *inactive_systems;   /* Frame systems with empty tables */
+    EcsArray *dirty_tables;       /* Tables with deferred (de)activation */
+    uint32_t deactivation_delay;  /* Frames an emptied table stays active */
+    EcsArray *queries;            /* Queries, matched with new tables */
+    uint32_t system_order;        /* Creation sequence of last system */
 
 
     /* -- Row systems -- */
@@ -273,6 +395,10 @@ struct EcsWorld {
     EcsArray *add_systems;        /* Systems invoked on ecs_stage_add */
     EcsArray *remove_systems;     /* Systems invoked on ecs_stage_remove */
     EcsArray *set_systems;        /* Systems invoked on ecs_set */
+    EcsMap *add_triggers;         /* OnAdd systems by one of their components */
+    EcsMap *remove_triggers;      /* OnRemove systems by one of their components */
+    EcsMap *set_triggers;         /* OnSet systems by one of their components */
+    uint32_t trigger_version;     /* Changes when row systems are added */
 
 
     /* -- Tasks -- */
@@ -281,18 +407,28 @@ struct EcsWorld {
     EcsArray *fini_tasks;         /* Tasks to execute on ecs_fini */
 
 
+    /* -- Type registry -- */
+
+    EcsTypeRecord *type_pages[ECS_MAX_TYPE_PAGES]; /* Records by type id */
+    EcsMap *type_index;           /* Index to find type ids by hash */
+    uint32_t type_count;          /* Number of registered types */
+    pthread_mutex_t type_mutex;   /* Mutex for registering types in threads */
+    uint32_t prefab_version;      /* Changes when the type of a prefab changes */
+
+
     /* -- Lookup Indices -- */
 
-    EcsMap *prefab_index;          /* Index to find prefabs in families */
-    EcsMap *type_sys_add_index;    /* Index to find add row systems for type */
-    EcsMap *type_sys_remove_index; /* Index to find remove row systems for type*/
-    EcsMap *type_sys_set_index;    /* Index to find set row systems for type */
+    EcsEntityIndex *entity_index; /* Entity lookup table of main stage */
     EcsMap *type_handles;          /* Handles to named families */
+    EcsMap *name_index;           /* Entities by hash of their EcsId */
+    pthread_mutex_t name_mutex;   /* Mutex for name index access in threads */
+    EcsMap *component_systems;    /* Column systems by a required component */
 
 
     /* -- Staging -- */
 
     EcsStage main_stage;          /* Main storage */
+    uint32_t simd_width;          /* Column padding in rows, 0 if unaligned */
     EcsStage temp_stage;          /* Stage for when processing systems */
     EcsArray *worker_stages;      /* Stages for worker threads */
 
@@ -330,11 +466,13 @@ struct EcsWorld {
 
     /* -- World state -- */
 
+    uint32_t change_version;      /* Increases for each column system run */
     bool valid_schedule;          /* Is job schedule still valid */
     bool quit_workers;            /* Signals worker threads to quit */
     bool in_progress;             /* Is world being progressed */
     bool is_merging;              /* Is world currently being merged */
     bool auto_merge;              /* Are stages auto-merged by ecs_progress */
+    bool deferred_activation;     /* Is table activation deferred to progress */
     bool measure_frame_time;      /* Time spent on each frame */
     bool measure_system_time;     /* Time spent by each system */
     bool should_quit;             /* Did a system signal that app should quit */
@@ -343,11 +481,14 @@ struct EcsWorld {
 
 /* Parameters for various array types */
 extern const EcsArrayParams handle_arr_params;
+extern const EcsArrayParams type_arr_params;
 extern const EcsArrayParams stage_arr_params;
 extern const EcsArrayParams table_arr_params;
 extern const EcsArrayParams thread_arr_params;
 extern const EcsArrayParams job_arr_params;
 extern const EcsArrayParams column_arr_params;
+extern const EcsArrayParams query_arr_params;
+extern const EcsArrayParams slice_arr_params;
 
 
 #endif
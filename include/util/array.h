@@ -26,6 +26,8 @@ struct EcsArrayParams {
     void *move_ctx;
     void *ctx;
     uint32_t element_size; /* Size of an element */
+    uint16_t alignment; /* Alignment of buffer (0 for default malloc alignment) */
+    uint16_t padding; /* Size is rounded up to a multiple of padding elements */
 };
 
 typedef struct EcsArrayIter {
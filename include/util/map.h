@@ -10,8 +10,7 @@ extern "C" {
 typedef struct EcsMap EcsMap;
 
 typedef struct EcsMapIter {
-    uint32_t bucket_index;
-    uint32_t node;
+    uint32_t index;
 } EcsMapIter;
 
 FLECS_EXPORT
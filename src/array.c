@@ -4,18 +4,96 @@
 struct EcsArray {
     uint32_t count;
     uint32_t size;
+    uint16_t alignment;  /* Alignment of buffer, 0 if allocated with malloc */
+    uint16_t padding;    /* Size is kept at a multiple of padding elements */
+    uint32_t reserved;   /* Keeps buffer aligned to 16 bytes */
 };
 
 #define ARRAY_BUFFER(array) ECS_OFFSET(array, sizeof(EcsArray))
 
-/** Resize the array buffer */
+/** Allocate array with room for size bytes. For aligned arrays the header is
+ * stored right before the aligned buffer. */
+static
+EcsArray* alloc_array(
+    uint16_t alignment,
+    uint32_t size)
+{
+    EcsArray *result;
+
+    if (!alignment) {
+        result = malloc(sizeof(EcsArray) + size);
+    } else {
+        void *base = NULL;
+        if (posix_memalign(&base, alignment, alignment + size)) {
+            base = NULL;
+        }
+
+        result = base
+            ? ECS_OFFSET(base, alignment - sizeof(EcsArray))
+            : NULL;
+    }
+
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
+    result->alignment = alignment;
+
+    return result;
+}
+
+/** Free memory of array */
+static
+void free_array(
+    EcsArray *array)
+{
+    if (!array) {
+        return;
+    }
+
+    if (array->alignment) {
+        free((char*)array - (array->alignment - sizeof(EcsArray)));
+    } else {
+        free(array);
+    }
+}
+
+/** Round size up to padding of array */
+static
+uint32_t pad_size(
+    uint32_t size,
+    uint16_t padding)
+{
+    if (padding > 1) {
+        size = ((size + padding - 1) / padding) * padding;
+    }
+
+    return size;
+}
+
+/** Resize the array buffer to hold size elements */
 static
 EcsArray* resize(
     EcsArray *array,
+    uint32_t element_size,
     uint32_t size)
 {
-    EcsArray *result = realloc(array, sizeof(EcsArray) + size);
-    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
+    EcsArray *result;
+
+    size = pad_size(size, array->padding);
+
+    if (!array->alignment) {
+        result = realloc(array, sizeof(EcsArray) + size * element_size);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
+    } else {
+        /* There is no aligned realloc, so copy to a new allocation */
+        uint32_t count = array->count;
+        if (count > array->size) count = array->size;
+        if (count > size) count = size;
+        result = alloc_array(array->alignment, size * element_size);
+        memcpy(result, array, sizeof(EcsArray) + count * element_size);
+        free_array(array);
+    }
+
+    result->size = size;
+
     return result;
 }
 
@@ -53,9 +131,16 @@ EcsArray* ecs_array_new(
     const EcsArrayParams *params,
     uint32_t size)
 {
-    EcsArray *result = malloc(sizeof(EcsArray) + size * params->element_size);
+    uint16_t alignment = params->alignment;
+    ecs_assert(!alignment || alignment >= sizeof(EcsArray), 
+        ECS_INVALID_PARAMETERS, NULL);
+
+    size = pad_size(size, params->padding);
+
+    EcsArray *result = alloc_array(alignment, size * params->element_size);
     result->count = 0;
     result->size = size;
+    result->padding = params->padding;
     return result;
 }
 
@@ -74,7 +159,7 @@ EcsArray* ecs_array_new_from_buffer(
 void ecs_array_free(
     EcsArray *array)
 {
-    free(array);
+    free_array(array);
 }
 
 void ecs_array_clear(
@@ -108,8 +193,7 @@ void* ecs_array_addn(
             }
         }
 
-        array = resize(array, size * element_size);
-        array->size = size;
+        array = resize(array, element_size, size);
         *array_inout = array;
     }
 
@@ -211,10 +295,8 @@ void ecs_array_reclaim(
     uint32_t count = array->count;
     uint32_t element_size = params->element_size;
 
-    if (count < size) {
-        size = count;
-        array = resize(array, size * element_size);
-        array->size = size;
+    if (pad_size(count, array->padding) < size) {
+        array = resize(array, element_size, count);
         *array_inout = array;
     }
 }
@@ -245,7 +327,7 @@ uint32_t ecs_array_set_size(
     EcsArray *array = *array_inout;
     if (!array) {
         *array_inout = ecs_array_new(params, size);
-        return size;
+        return (*array_inout)->size;
     } else {
         uint32_t result = array->size;
 
@@ -254,10 +336,9 @@ uint32_t ecs_array_set_size(
         }
 
         if (result < size) {
-            array = resize(array, size * params->element_size);
-            array->size = size;
+            array = resize(array, params->element_size, size);
             *array_inout = array;
-            result = size;
+            result = array->size;
         }
 
         return result;
@@ -360,7 +441,8 @@ void ecs_array_memory(
 {
     if (!array) return;
     if (allocd) {
-        *allocd += array->size * params->element_size + sizeof(EcsArray);
+        *allocd += array->size * params->element_size + sizeof(EcsArray) +
+            (array->alignment ? array->alignment - sizeof(EcsArray) : 0);
     }
     if (used) {
         *used += array->count * params->element_size;
@@ -3,74 +3,38 @@
 #include <stdarg.h>
 #include "include/private/flecs.h"
 
-static
-void copy_column(
-    EcsTableColumn *new_column,
-    uint32_t new_index,
-    EcsTableColumn *old_column,
-    uint32_t old_index)
-{
-    uint32_t size = new_column->size;
-
-    if (size) {
-        EcsArrayParams param = {.element_size = new_column->size};
-        void *dst = ecs_array_get(new_column->data, &param, new_index);
-        void *src = ecs_array_get(old_column->data, &param, old_index);
-            
-        ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
-        ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
-
-        memcpy(dst, src, param.element_size);
-    }
-}
-
+/** Copy components of an entity to another table, using the move plan */
 static
 void copy_row(
-    EcsArray *new_type,
+    EcsWorld *world,
+    EcsTable *new_table,
     EcsTableColumn *new_columns,
     uint32_t new_index,
-    EcsArray *old_type,
+    EcsTable *old_table,
     EcsTableColumn *old_columns,
     uint32_t old_index)
 {
-    uint16_t i_new, new_component_count = ecs_array_count(new_type);
-    uint16_t i_old = 0, old_component_count = ecs_array_count(old_type);
-    EcsEntity *new_components = ecs_array_buffer(new_type);
-    EcsEntity *old_components = ecs_array_buffer(old_type);
+    EcsMovePlan *plan = ecs_table_get_move_plan(world, old_table, new_table);
+    EcsMovePlan *tmp_plan = NULL;
 
-    ecs_assert(old_columns->data != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(new_columns->data != NULL, ECS_INTERNAL_ERROR, NULL);
+    if (!plan) {
+        plan = tmp_plan = ecs_table_new_move_plan(world, old_table, new_table);
+    }
 
-    for (i_new = 0; i_new < new_component_count; ) {
-        if (i_old == old_component_count) {
-            break;
-        }
+    ecs_table_copy_w_plan(
+        plan, new_columns, new_index, old_columns, old_index, 1);
 
-        EcsEntity new_component = new_components[i_new];
-        EcsEntity old_component = old_components[i_old];
-
-        if (new_component == old_component) {
-            copy_column(&new_columns[i_new + 1], new_index, &old_columns[i_old + 1], old_index);
-            i_new ++;
-            i_old ++;
-        } else if (new_component < old_component) {
-            i_new ++;
-        } else if (new_component > old_component) {
-            i_old ++;
-        }
-    }
+    free(tmp_plan);
 }
 
 static
 void* get_row_ptr(
-    EcsWorld *world,
-    EcsStage *stage,
-    EcsArray *type,
+    EcsTable *table,
     EcsTableColumn *columns,
     uint32_t index,
     EcsEntity component)
 {
-    uint32_t column_index = ecs_type_index_of(type, component);
+    int16_t column_index = ecs_table_column_index(table, component);
     if (column_index == -1) {
         return NULL;
     }
@@ -86,6 +50,42 @@ void* get_row_ptr(
     }
 }
 
+/** Get row of entity from the entity index of a stage. The main stage stores
+ * its rows in the world entity index, other stages use a map. */
+static
+EcsRow get_row(
+    EcsWorld *world,
+    EcsStage *stage,
+    EcsEntity entity)
+{
+    if (stage == &world->main_stage) {
+        return ecs_entity_index_get(world->entity_index, entity);
+    } else {
+        return ecs_to_row(ecs_map_get64(stage->entity_index, entity));
+    }
+}
+
+/** Set row of entity in the entity index of a stage. An empty row removes the
+ * entity from the main stage, but is stored in other stages so that the merge
+ * knows the entity has to be merged. */
+static
+void set_row(
+    EcsWorld *world,
+    EcsStage *stage,
+    EcsEntity entity,
+    EcsRow row)
+{
+    if (stage == &world->main_stage) {
+        if (row.type_id) {
+            ecs_entity_index_set(world->entity_index, entity, row);
+        } else {
+            ecs_entity_index_remove(world->entity_index, entity);
+        }
+    } else {
+        ecs_map_set64(stage->entity_index, entity, ecs_from_row(row));
+    }
+}
+
 static
 void* get_ptr(
     EcsWorld *world,
@@ -112,8 +112,7 @@ void* get_ptr(
             info->index = row.index;
             info->table = table;
             info->columns = columns;
-            ptr = get_row_ptr(
-                world, stage, table->type, columns, row.index, component);  
+            ptr = get_row_ptr(table, columns, row.index, component);
         }
 
         if (!ptr) {
@@ -135,9 +134,8 @@ void* get_ptr(
     EcsEntity prefab = 0;
 
     if (!world->in_progress || !staged_only) {
-        row_64 = ecs_map_get64(world->main_stage.entity_index, entity);
-        if (row_64) {
-            EcsRow row = ecs_to_row(row_64);
+        EcsRow row = ecs_entity_index_get(world->entity_index, entity);
+        if (row.type_id) {
             type_id = row.type_id;
             EcsTable *table = ecs_world_get_table(world, stage, type_id);
             info->entity = entity;
@@ -145,23 +143,39 @@ void* get_ptr(
             info->index = row.index;
             info->table = table;
             info->columns = table->columns;
-            ptr = get_row_ptr(
-                world, stage, table->type, table->columns, row.index, component);
+            ptr = get_row_ptr(table, table->columns, row.index, component);
         }
 
         if (ptr) return ptr;
 
         if (type_id && search_prefab) {
-            prefab = ecs_map_get64(world->prefab_index, type_id);
+            prefab = ecs_type_get_prefab(world, type_id);
         }
     }
 
     if (!prefab && staged_id && search_prefab) {
-        prefab = ecs_map_get64(world->prefab_index, staged_id);
+        prefab = ecs_type_get_prefab(world, staged_id);
     }
 
     if (prefab) {
         if (component != EEcsId && component != EEcsPrefab) {
+            /* Find the prefab that owns the component in one lookup, instead
+             * of walking the prefab chain */
+            if (type_id) {
+                EcsEntity owner = ecs_type_get_prefab_owner(
+                    world, type_id, component);
+                if (owner) {
+                    return get_ptr(
+                        world, owner, component, staged_only, false, info);
+                }
+
+                /* Only components added to a prefab in this iteration are not
+                 * in the cache, as prefabs are resolved from the main stage */
+                if (!world->in_progress) {
+                    return NULL;
+                }
+            }
+
             return get_ptr(world, prefab, component, staged_only, true, info);
         } else {
             return NULL;
@@ -183,7 +197,6 @@ void copy_from_prefab(
     EcsType type_id,
     EcsType to_add)
 {
-    EcsEntity prefab;
     EcsType entity_type = type_id;
 
     if (world->in_progress) {
@@ -194,50 +207,57 @@ void copy_from_prefab(
         }
     }
 
-    while ((prefab = ecs_map_get64(world->prefab_index, entity_type))) {
-        /* Prefabs are only resolved from the main stage. Prefabs created while
-         * iterating cannot be resolved in the same iteration. */
-        EcsRow row = ecs_to_row(ecs_map_get64(world->main_stage.entity_index, prefab));
+    if (!ecs_type_get_prefab(world, entity_type)) {
+        return;
+    }
+
+    EcsTableColumn *columns;
+    if (world->in_progress) {
+        columns = ecs_map_get(stage->data_stage, type_id);
+    } else {
+        columns = table->columns;
+    }
+
+    EcsArray *add_type = ecs_type_get(world, stage, to_add);
+    EcsEntity *add_handles = ecs_array_buffer(add_type);
+    uint32_t i, add_count = ecs_array_count(add_type);
+
+    for (i = 0; i < add_count; i ++) {
+        EcsEntity component = add_handles[i];
+
+        /* The nearest prefab in the chain that owns the component provides the
+         * value. Prefabs are only resolved from the main stage. Prefabs created
+         * while iterating cannot be resolved in the same iteration. */
+        EcsEntity owner = ecs_type_get_prefab_owner(
+            world, entity_type, component);
+        if (!owner) {
+            continue;
+        }
 
+        EcsRow row = ecs_entity_index_get(world->entity_index, owner);
         EcsTable *prefab_table = ecs_world_get_table(
             world, stage, row.type_id);
 
-        EcsArray *add_type = ecs_type_get(world, stage, to_add);
-        EcsEntity *add_handles = ecs_array_buffer(add_type);
-        uint32_t i, add_count = ecs_array_count(add_type);
-
-        for (i = 0; i < add_count; i ++) {
-            EcsEntity component = add_handles[i];
-            void *prefab_ptr = get_row_ptr(
-                world, stage, prefab_table->type, prefab_table->columns,
-                row.index, component);
+        void *prefab_ptr = get_row_ptr(
+            prefab_table, prefab_table->columns, row.index, component);
+        if (!prefab_ptr) {
+            continue;
+        }
 
-            if (prefab_ptr) {
-                EcsTableColumn *columns;
-                if (world->in_progress) {
-                    columns = ecs_map_get(stage->data_stage, type_id);
-                } else {
-                    columns = table->columns;
-                }
+        int16_t column_index = ecs_table_column_index(table, component);
+        if (column_index == -1) {
+            continue;
+        }
 
-                uint32_t size = columns->size;
-
-                if (size) {
-                    void *ptr = get_row_ptr(
-                        world, stage, table->type, columns, offset, component);
-                    if (ptr) {
-                        int i;
-                        for (i = 0; i < limit; i ++) {
-                            memcpy(ptr, prefab_ptr, size);
-                            ptr = ECS_OFFSET(ptr, size);
-                        }
-                    }
-                }
+        uint32_t size = columns[column_index + 1].size;
+        void *ptr = get_row_ptr(table, columns, offset, component);
+        if (ptr) {
+            uint32_t e;
+            for (e = 0; e < limit; e ++) {
+                memcpy(ptr, prefab_ptr, size);
+                ptr = ECS_OFFSET(ptr, size);
             }
         }
-
-        /* Recursively search through prefabs */
-        entity_type = row.type_id;
     }
 }
 
@@ -249,21 +269,26 @@ bool notify_pre_merge(
     uint32_t offset,
     uint32_t limit,
     EcsType to_init,
-    EcsMap *systems)
+    EcsSystemKind kind)
 {
-    if (world->is_merging) {
+    /* World may be a thread, which is passed on to the row systems so that they
+     * use the stage of the thread */
+    EcsWorld *real_world = world;
+    ecs_get_stage(&real_world);
+
+    if (real_world->is_merging) {
         return false;
     }
 
-    bool in_progress = world->in_progress;
-    world->in_progress = true;
+    bool in_progress = real_world->in_progress;
+    real_world->in_progress = true;
 
     bool result = ecs_notify(
-        world, systems, to_init, table, table_columns, offset, limit);
+        world, kind, to_init, table, table_columns, offset, limit);
 
-    world->in_progress = in_progress;
+    real_world->in_progress = in_progress;
     if (result && !in_progress) {
-        ecs_merge(world);
+        ecs_merge(real_world);
 
     }
 
@@ -289,7 +314,7 @@ bool notify_post_merge(
     world->is_merging = true;
 
     bool result = ecs_notify(
-        world, world->type_sys_remove_index, to_deinit, table, 
+        world, EcsOnRemove, to_deinit, table, 
         table_columns, offset, limit);
 
     world->is_merging = is_merging;
@@ -297,6 +322,22 @@ bool notify_post_merge(
     return result;
 }
 
+/** Get handle for a new entity. Ids of deleted entities are recycled, except
+ * when worker threads may be creating entities at the same time. */
+static
+EcsEntity new_entity_handle(
+    EcsWorld *world)
+{
+    if (!world->in_progress || !world->threads_running) {
+        EcsEntity result = ecs_entity_index_recycle(world->entity_index);
+        if (result) {
+            return result;
+        }
+    }
+
+    return ++ world->last_handle;
+}
+
 /** Commit an entity with a specified type to memory */
 static
 uint32_t commit_w_type(
@@ -309,14 +350,10 @@ uint32_t commit_w_type(
 {
     EcsTable *old_table, *new_table = NULL;
     EcsTableColumn *new_columns, *old_columns;
-    EcsMap *entity_index;
     EcsType old_type_id = 0;
     uint32_t new_index = -1, old_index = -1;
     bool in_progress = world->in_progress;
     EcsEntity entity = info->entity;
-    EcsArray *old_type = NULL;
-
-    entity_index = stage->entity_index;
 
     /* Always update remove_merge stage when in progress. It is possible (and
      * likely) that when a component is removed, it hasn't been added in the
@@ -348,7 +385,6 @@ uint32_t commit_w_type(
             old_columns = old_table->columns;
         }
 
-        old_type = old_table->type;
     }
 
     if (type_id) {
@@ -384,21 +420,26 @@ uint32_t commit_w_type(
     }
 
     if (old_type_id && type_id) {
-        copy_row(new_table->type, new_columns, new_index, 
-            old_type, old_columns, old_index);
+        copy_row(world, new_table, new_columns, new_index, 
+            old_table, old_columns, old_index);
     }
 
     if (type_id) {
         EcsRow new_row = (EcsRow){.type_id = type_id, .index = new_index};
-        ecs_map_set64(entity_index, entity, ecs_from_row(new_row));
+        set_row(world, stage, entity, new_row);
     } else {
-        if (in_progress) {
-            /* The entity must be kept in the stage index because otherwise the
-             * merge doesn't know that it needs to merge data for the entity */
-            ecs_map_set64(entity_index, entity, 0);
-        } else {
-            ecs_map_remove(entity_index, entity);
-        }
+        /* When in progress, the entity must be kept in the stage index because
+         * otherwise the merge doesn't know that it needs to merge data for the
+         * entity. set_row only removes the entity from the main stage. */
+        set_row(world, stage, entity, (EcsRow){0, 0});
+    }
+
+    /* Inherited components are cached per type, so the cache is invalidated
+     * whenever the type of a prefab changes */
+    if (!in_progress && (ecs_type_is_prefab(world, old_type_id) || 
+        ecs_type_is_prefab(world, type_id)))
+    {
+        world->prefab_version ++;
     }
 
     if (!in_progress) {
@@ -437,8 +478,7 @@ uint32_t commit_w_type(
     if (type_id) {
         if (to_add) {
             notify_pre_merge (
-                world, new_table, new_columns, new_index, 1, to_add, 
-                world->type_sys_add_index);
+                world, new_table, new_columns, new_index, 1, to_add, EcsOnAdd);
 
             copy_from_prefab(
                 world, stage, new_table, entity, new_index, 1, type_id, to_add);
@@ -453,18 +493,216 @@ uint32_t commit_w_type(
 }
 
 
+/** Add or remove a type for all entities that match a filter. Instead of moving
+ * entities one by one, all rows of a matching table are moved to the
+ * destination table at once, with one copy per column. OnAdd and OnRemove
+ * systems are invoked once per table. */
+static
+void commit_w_filter(
+    EcsWorld *world,
+    EcsType type,
+    EcsType filter,
+    bool add)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(type != 0, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(filter != 0, ECS_INVALID_PARAMETERS, NULL);
+
+    /* Keep world as is, so that staged operations end up in the right stage */
+    EcsWorld *real_world = world;
+    EcsStage *stage = ecs_get_stage(&real_world);
+
+    ecs_assert(!real_world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+
+    /* Tables created by this operation are destination tables, which already
+     * have the new type and don't need to be visited */
+    uint32_t i, count = ecs_array_count(real_world->main_stage.tables);
+
+    for (i = 0; i < count; i ++) {
+        EcsTable *table = ecs_array_get(
+            real_world->main_stage.tables, &table_arr_params, i);
+        if (!table->type) {
+            continue;
+        }
+
+        EcsArray *entity_column = table->columns[0].data;
+        uint32_t e, row_count = ecs_array_count(entity_column);
+        if (!row_count) {
+            continue;
+        }
+
+        if (!ecs_type_contains(
+            real_world, stage, table->type_id, filter, true, true))
+        {
+            continue;
+        }
+
+        EcsEntity *entities = ecs_array_buffer(entity_column);
+
+        /* Tables cannot be modified while they are iterated, so when in
+         * progress, stage the operation for each entity */
+        if (real_world->in_progress) {
+            for (e = 0; e < row_count; e ++) {
+                if (add) {
+                    _ecs_add(world, entities[e], type);
+                } else {
+                    _ecs_remove(world, entities[e], type);
+                }
+            }
+            continue;
+        }
+
+        EcsType dst_type_id;
+        if (add) {
+            dst_type_id = ecs_table_traverse_add(real_world, stage, table, type);
+        } else {
+            dst_type_id = ecs_table_traverse_remove(
+                real_world, stage, table, type);
+        }
+
+        if (dst_type_id == table->type_id) {
+            continue;
+        }
+
+        if (ecs_type_is_prefab(real_world, table->type_id) || 
+            ecs_type_is_prefab(real_world, dst_type_id))
+        {
+            real_world->prefab_version ++;
+        }
+
+        if (!add) {
+            notify_post_merge(real_world, table, table->columns, 0, row_count, 
+                type);
+        }
+
+        /* If all components are removed, entities are no longer stored in a
+         * table, but they remain alive */
+        if (!dst_type_id) {
+            for (e = 0; e < row_count; e ++) {
+                ecs_entity_index_remove(real_world->entity_index, entities[e]);
+            }
+
+            ecs_table_clear(real_world, table);
+            continue;
+        }
+
+        /* Getting the destination table can create a new table, which may
+         * reallocate the table array */
+        EcsTable *dst_table = ecs_world_get_table(real_world, stage, dst_type_id);
+        table = ecs_array_get(
+            real_world->main_stage.tables, &table_arr_params, i);
+
+        uint32_t offset = ecs_table_move_all(real_world, dst_table, table);
+        ecs_assert(offset != (uint32_t)-1, ECS_OUT_OF_MEMORY, NULL);
+
+        entities = ecs_array_buffer(dst_table->columns[0].data);
+        EcsEntity first_entity = entities[offset];
+
+        for (e = 0; e < row_count; e ++) {
+            EcsRow row = {.type_id = dst_type_id, .index = offset + e};
+            ecs_entity_index_set(real_world->entity_index, entities[offset + e], row);
+        }
+
+        if (add) {
+            notify_pre_merge(real_world, dst_table, dst_table->columns, offset, 
+                row_count, type, EcsOnAdd);
+
+            copy_from_prefab(real_world, stage, dst_table, first_entity, offset, 
+                row_count, dst_type_id, type);
+        }
+    }
+
+    real_world->valid_schedule = false;
+}
+
+
+/** Get table of main stage from array, as tables may have been reallocated */
+static
+EcsTable* main_table(
+    EcsWorld *world,
+    EcsType type_id)
+{
+    return ecs_array_get(world->main_stage.tables, &table_arr_params, type_id);
+}
+
+/** Test if the tables from which a reference was resolved are unchanged */
+static
+bool ref_is_valid(
+    EcsWorld *world,
+    EcsRef *ref)
+{
+    if (!ref->type_id) {
+        return false;
+    }
+
+    if (main_table(world, ref->type_id)->version != ref->version) {
+        return false;
+    }
+
+    if (ref->src_type_id && 
+        main_table(world, ref->src_type_id)->version != ref->src_version)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/** Resolve component of reference in the main stage, store where it was found */
+static
+void* resolve_ref(
+    EcsWorld *world,
+    EcsRef *ref)
+{
+    EcsEntity entity = ref->entity;
+    EcsEntity component = ecs_entity_from_type(world, ref->component);
+    EcsEntityInfo info = {0};
+    void *ptr = get_ptr(world, entity, component, false, true, &info);
+    EcsRow row = ecs_entity_index_get(world->entity_index, entity);
+
+    ref->ptr = ptr;
+    ref->type_id = 0;
+    ref->src_type_id = 0;
+
+    /* Only cache pointers to components of the entity itself or of its direct
+     * prefab, as these are the only tables that are tracked */
+    if (!ptr || !row.type_id) {
+        return ptr;
+    }
+
+    if (info.entity != entity) {
+        if (ecs_type_get_prefab(world, row.type_id) != info.entity) {
+            return ptr;
+        }
+
+        ref->src_type_id = info.type_id;
+        ref->src_version = main_table(world, info.type_id)->version;
+    }
+
+    ref->type_id = row.type_id;
+    ref->version = main_table(world, row.type_id)->version;
+
+    return ptr;
+}
+
+
 /* -- Private functions -- */
 
 bool ecs_notify(
     EcsWorld *world,
-    EcsMap *index,
+    EcsSystemKind kind,
     EcsType type_id,
     EcsTable *table,
     EcsTableColumn *table_columns,
     int32_t offset,
     int32_t limit)
 {
-    EcsArray *systems = ecs_map_get(index, type_id);
+    EcsWorld *real_world = world;
+    ecs_get_stage(&real_world);
+
+    bool is_temp;
+    EcsArray *systems = ecs_row_systems_for_type(
+        real_world, type_id, kind, &is_temp);
     bool notified = false;
 
     if (systems) {
@@ -473,7 +711,11 @@ bool ecs_notify(
 
         for (i = 0; i < count; i ++) {
             notified |= ecs_notify_row_system(
-                world, buffer[i], table->type, table_columns, offset, limit);
+                world, buffer[i], table, table_columns, offset, limit);
+        }
+
+        if (is_temp) {
+            ecs_array_free(systems);
         }
     } 
 
@@ -486,11 +728,14 @@ void ecs_merge_entity(
     EcsEntity entity,
     EcsRow *staged_row)
 {
-    EcsRow old_row = {0};
+    /* Entity may have been deleted by a stage that was merged earlier */
+    if (!ecs_entity_index_is_alive(world->entity_index, entity)) {
+        return;
+    }
+
     EcsTable *old_table = NULL;
-    uint64_t old_row_64 = ecs_map_get64(world->main_stage.entity_index, entity);
-    if (old_row_64) {
-        old_row = ecs_to_row(old_row_64);
+    EcsRow old_row = ecs_entity_index_get(world->entity_index, entity);
+    if (old_row.type_id) {
         old_table = ecs_world_get_table(world, stage, old_row.type_id);
     }
 
@@ -517,9 +762,51 @@ void ecs_merge_entity(
         EcsTableColumn *staged_columns = ecs_map_get(
             stage->data_stage, staged_row->type_id);
 
-        copy_row( new_table->type, new_table->columns, new_index,
-                  staged_table->type, staged_columns, staged_row->index); 
+        copy_row(world, new_table, new_table->columns, new_index,
+            staged_table, staged_columns, staged_row->index);
+
+        /* Mark columns that received staged values as changed */
+        EcsEntity *components = ecs_array_buffer(staged_table->type);
+        uint32_t i, count = ecs_array_count(staged_table->type);
+        for (i = 0; i < count; i ++) {
+            int16_t column_index = ecs_table_column_index(
+                new_table, components[i]);
+            if (column_index != -1) {
+                new_table->columns[column_index + 1].version = 
+                    world->change_version;
+            }
+        }
+    }
+}
+
+void* ecs_get_ref_ptr(
+    EcsWorld *world,
+    EcsRef *ref,
+    bool update)
+{
+    EcsWorld *real_world = world;
+    EcsStage *stage = ecs_get_stage(&real_world);
+    EcsEntity entity = ref->entity;
+
+    /* If the entity was changed in this iteration, the cached pointer may not
+     * point to the most recent data */
+    if (real_world->in_progress) {
+        if (ecs_map_get64(stage->entity_index, entity) || 
+            ecs_map_get64(stage->remove_merge, entity)) 
+        {
+            return _ecs_get_ptr(world, entity, ref->component);
+        }
+    }
+
+    if (ref_is_valid(real_world, ref)) {
+        return ref->ptr;
+    }
+
+    if (!update) {
+        return _ecs_get_ptr(world, entity, ref->component);
     }
+
+    return resolve_ref(real_world, ref);
 }
 
 /* -- Public functions -- */
@@ -535,11 +822,10 @@ EcsEntity ecs_clone(
 
     ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
 
-    EcsEntity result = ++ world->last_handle;
+    EcsEntity result = new_entity_handle(world);
     if (entity) {
-        int64_t row64 = ecs_map_get64(world->main_stage.entity_index, entity);
-        if (row64) {
-            EcsRow row = ecs_to_row(row64);
+        EcsRow row = ecs_entity_index_get(world->entity_index, entity);
+        if (row.type_id) {
             EcsType type_id = row.type_id;
             EcsEntityInfo info = {
                 .entity = result,
@@ -561,7 +847,7 @@ EcsEntity ecs_clone(
                     to_columns = to_table->columns;
                 }
 
-                to_row = ecs_to_row(ecs_map_get64(stage->entity_index, result));
+                to_row = get_row(world, stage, result);
 
                 if (!to_table)
                     to_table = from_table;
@@ -570,15 +856,21 @@ EcsEntity ecs_clone(
                     to_columns = from_columns;
 
                 if (!to_row.index)
-                    to_row = ecs_to_row(ecs_map_get64(
-                            world->main_stage.entity_index, result));
+                    to_row = ecs_entity_index_get(world->entity_index, result);
 
-                copy_row(to_table->type, to_columns, to_row.index,
-                    from_table->type, from_columns, row.index);
+                copy_row(world, to_table, to_columns, to_row.index,
+                    from_table, from_columns, row.index);
+
+                /* The id is copied without ecs_set, so add it to the index */
+                EcsId *id = get_row_ptr(
+                    to_table, to_columns, to_row.index, EEcsId);
+                if (id) {
+                    ecs_world_register_name(world, result, *id);
+                }
 
                 /* A clone with value is equivalent to a set */
                 ecs_notify(
-                    world, world->type_sys_set_index, from_table->type_id, 
+                    world, EcsOnSet, from_table->type_id, 
                     to_table, to_columns, to_row.index, 1);
             }
         }
@@ -597,7 +889,7 @@ EcsEntity _ecs_new(
 
     ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
 
-    EcsEntity entity = ++ world->last_handle;
+    EcsEntity entity = new_entity_handle(world);
     if (type) {
         EcsEntityInfo info = {
             .entity = entity
@@ -658,10 +950,13 @@ EcsEntity _ecs_new_w_count(
         EcsTable *table = ecs_world_get_table(world, stage, type);
         uint32_t row = ecs_table_grow(world, table, table->columns, count, result);
 
-        EcsMap *entity_index = stage->entity_index;
-
-        uint32_t cur_index_count = ecs_map_count(entity_index);
-        ecs_map_set_size(entity_index, cur_index_count + count);
+        if (stage == &world->main_stage) {
+            ecs_entity_index_set_size(world->entity_index, result, count);
+        } else {
+            EcsMap *entity_index = stage->entity_index;
+            uint32_t cur_index_count = ecs_map_count(entity_index);
+            ecs_map_set_size(entity_index, cur_index_count + count);
+        }
 
         int i, cur_row = row;
         for (i = result; i < (result + count); i ++) {
@@ -669,7 +964,7 @@ EcsEntity _ecs_new_w_count(
              * the entity index */
 
             EcsRow new_row = (EcsRow){.type_id = type, .index = cur_row};
-            ecs_map_set64(entity_index, i, ecs_from_row(new_row));
+            set_row(world, stage, i, new_row);
 
             cur_row ++;
         }
@@ -677,7 +972,7 @@ EcsEntity _ecs_new_w_count(
         /* Now we can notify matching OnAdd row systems in bulk */
         notify_pre_merge(
             world, table, table->columns, row, count, 
-            type, world->type_sys_add_index);
+            type, EcsOnAdd);
         
         /* Check if there are prefabs */
         copy_from_prefab(world, stage, table, result, row, count, type, type);
@@ -693,6 +988,130 @@ EcsEntity _ecs_new_w_count(
     return result;
 }
 
+/** Set component values of a range of new entities one entity at a time */
+static
+void set_w_data(
+    EcsWorld *world,
+    EcsEntity first,
+    uint32_t count,
+    EcsArray *type,
+    void **data)
+{
+    EcsEntity *components = ecs_array_buffer(type);
+    uint32_t c, component_count = ecs_array_count(type);
+
+    for (c = 0; c < component_count; c ++) {
+        if (!data[c]) {
+            continue;
+        }
+
+        EcsComponent *cdata = ecs_get_ptr(world, components[c], EcsComponent);
+        ecs_assert(cdata != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+        EcsType component_type = ecs_type_from_entity(world, components[c]);
+
+        uint32_t e, size = cdata->size;
+        for (e = 0; e < count; e ++) {
+            _ecs_set_ptr(world, first + e, component_type, size, 
+                ECS_OFFSET(data[c], size * e));
+        }
+    }
+}
+
+EcsEntity _ecs_new_w_data(
+    EcsWorld *world,
+    EcsType type,
+    uint32_t count,
+    void **data,
+    EcsEntity *handles_out)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(type != 0, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(data != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    EcsWorld *real_world = world;
+    EcsStage *stage = ecs_get_stage(&real_world);
+    EcsArray *type_arr = ecs_type_get(real_world, stage, type);
+    EcsEntity result;
+
+    ecs_assert(type_arr != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    /* Tables cannot be modified while in progress, so entities are created
+     * and set individually, which stages the values */
+    if (real_world->in_progress) {
+        uint32_t i;
+        result = real_world->last_handle + 1;
+        real_world->last_handle += count;
+
+        for (i = 0; i < count; i ++) {
+            _ecs_add(world, result + i, type);
+            if (handles_out) {
+                handles_out[i] = result + i;
+            }
+        }
+
+        set_w_data(world, result, count, type_arr, data);
+        return result;
+    }
+
+    result = _ecs_new_w_count(world, type, count, handles_out);
+
+    EcsRow row = ecs_entity_index_get(world->entity_index, result);
+    EcsTable *table = ecs_world_get_table(world, stage, type);
+    EcsEntity *entities = ecs_array_buffer(table->columns[0].data);
+    uint32_t i, table_count = ecs_array_count(table->columns[0].data);
+
+    /* OnAdd systems may have moved entities out of the table, in which case
+     * the new entities are no longer stored in a contiguous range */
+    bool contiguous = row.type_id == type && row.index + count <= table_count;
+    for (i = 0; contiguous && i < count; i ++) {
+        contiguous = entities[row.index + i] == result + i;
+    }
+
+    if (!contiguous) {
+        set_w_data(world, result, count, type_arr, data);
+        return result;
+    }
+
+    EcsEntity *components = ecs_array_buffer(type_arr);
+    uint32_t component_count = ecs_array_count(type_arr);
+    EcsType set_type = 0;
+
+    /* Copy buffers into the columns with one memcpy per component. Values are
+     * copied after OnAdd systems and prefabs initialized the columns. */
+    for (i = 0; i < component_count; i ++) {
+        if (!data[i]) {
+            continue;
+        }
+
+        EcsTableColumn *column = &table->columns[i + 1];
+        if (column->size) {
+            EcsArrayParams params = {.element_size = column->size};
+            void *dst = ecs_array_get(column->data, &params, row.index);
+            memcpy(dst, data[i], column->size * count);
+        }
+
+        if (components[i] == EEcsId) {
+            EcsId *ids = data[i];
+            uint32_t e;
+            for (e = 0; e < count; e ++) {
+                ecs_world_register_name(world, result + e, ids[e]);
+            }
+        }
+
+        set_type = ecs_type_merge(world, stage, set_type, 
+            ecs_type_from_handle(world, stage, components[i], NULL), 0);
+    }
+
+    /* Notify matching OnSet row systems in bulk */
+    if (set_type) {
+        notify_pre_merge(
+            world, table, table->columns, row.index, count, set_type, EcsOnSet);
+    }
+
+    return result;
+}
+
 void ecs_delete(
     EcsWorld *world,
     EcsEntity entity)
@@ -703,10 +1122,14 @@ void ecs_delete(
     EcsStage *stage = ecs_get_stage(&world);
     bool in_progress = world->in_progress;
 
+    /* Deleting a handle that has already been deleted is a no-op */
+    if (!ecs_is_alive(world, entity)) {
+        return;
+    }
+
     if (!in_progress) {
-        uint64_t row64;
-        if (ecs_map_has(world->main_stage.entity_index, entity, &row64)) {
-            EcsRow row = ecs_to_row(row64);
+        EcsRow row = ecs_entity_index_get(world->entity_index, entity);
+        if (row.type_id) {
             EcsEntityInfo info = {
                 .entity = entity,
                 .type_id = row.type_id,
@@ -715,22 +1138,88 @@ void ecs_delete(
             };
 
             commit_w_type(world, stage, &info, 0, 0, row.type_id);
-
-            ecs_map_remove(world->main_stage.entity_index, entity);
         }
+
+        ecs_entity_index_delete(world->entity_index, entity);
     } else {
         /* Mark components of the entity in the main stage as removed. This will
          * ensure that subsequent calls to ecs_has, ecs_get and ecs_empty will
          * behave consistently with the delete. */
-        uint64_t row64 = ecs_map_get64(world->main_stage.entity_index, entity);
-        if (row64) {
-            EcsRow row = ecs_to_row(row64);
+        EcsRow row = ecs_entity_index_get(world->entity_index, entity);
+        if (row.type_id) {
             ecs_map_set64(stage->remove_merge, entity, row.type_id);
         }
 
         /* Remove the entity from the staged index. Any added components while
          * in progress will be discarded as a result. */
         ecs_map_set64(stage->entity_index, entity, 0);
+
+        /* The id of the entity is recycled when the stage is merged */
+        EcsEntity *elem = ecs_array_add(&stage->delete_stage, &handle_arr_params);
+        *elem = entity;
+    }
+}
+
+void _ecs_delete_w_filter(
+    EcsWorld *world,
+    EcsType filter)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(filter != 0, ECS_INVALID_PARAMETERS, NULL);
+
+    /* Keep world as is, so that staged deletes end up in the right stage */
+    EcsWorld *real_world = world;
+    EcsStage *stage = ecs_get_stage(&real_world);
+
+    ecs_assert(!real_world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+
+    uint32_t i, count = ecs_array_count(real_world->main_stage.tables);
+
+    for (i = 0; i < count; i ++) {
+        /* Get table from array in every iteration, as OnRemove systems could
+         * create new tables */
+        EcsTable *table = ecs_array_get(
+            real_world->main_stage.tables, &table_arr_params, i);
+        if (!table->type) {
+            continue;
+        }
+
+        EcsArray *entity_column = table->columns[0].data;
+        uint32_t e, row_count = ecs_array_count(entity_column);
+        if (!row_count) {
+            continue;
+        }
+
+        if (!ecs_type_contains(
+            real_world, stage, table->type_id, filter, true, true))
+        {
+            continue;
+        }
+
+        EcsEntity *entities = ecs_array_buffer(entity_column);
+
+        /* Tables cannot be modified while they are iterated, so when in
+         * progress, stage a delete for each entity */
+        if (real_world->in_progress) {
+            for (e = 0; e < row_count; e ++) {
+                ecs_delete(world, entities[e]);
+            }
+            continue;
+        }
+
+        if (ecs_type_is_prefab(real_world, table->type_id)) {
+            real_world->prefab_version ++;
+        }
+
+        /* Invoke OnRemove systems once for all entities in table */
+        notify_post_merge(real_world, table, table->columns, 0, row_count, 
+            table->type_id);
+
+        for (e = 0; e < row_count; e ++) {
+            ecs_entity_index_delete(real_world->entity_index, entities[e]);
+        }
+
+        ecs_table_clear(real_world, table);
     }
 }
 
@@ -743,19 +1232,16 @@ EcsResult _ecs_add(
     EcsStage *stage = ecs_get_stage(&world);
     ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
     
-    EcsMap *entity_index = stage->entity_index;
     EcsType dst_type = 0;
     EcsEntityInfo info = {.entity = entity};
 
-    uint64_t row_64 = ecs_map_get64(entity_index, entity);
-    if (row_64) {
-        EcsRow row = ecs_to_row(row_64);
+    EcsRow row = get_row(world, stage, entity);
+    if (row.type_id) {
         info.table = ecs_world_get_table(world, stage, row.type_id);
         info.columns = info.table->columns;
         info.index = row.index;
         info.type_id = row.type_id;
-        EcsArray *to_add = ecs_type_get(world, stage, type);
-        dst_type = ecs_type_merge_arr(world, stage, info.table->type, to_add, NULL);
+        dst_type = ecs_table_traverse_add(world, stage, info.table, type);
     } else {
         dst_type = type;
     }
@@ -772,19 +1258,16 @@ EcsResult _ecs_remove(
     EcsStage *stage = ecs_get_stage(&world);
     ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
 
-    EcsMap *entity_index = stage->entity_index;
     EcsType dst_type = 0;
     EcsEntityInfo info = {.entity = entity};
 
-    uint64_t row_64 = ecs_map_get64(entity_index, entity);
-    if (row_64) {
-        EcsRow row = ecs_to_row(row_64);
+    EcsRow row = get_row(world, stage, entity);
+    if (row.type_id) {
         info.table = ecs_world_get_table(world, stage, row.type_id);
         info.columns = info.table->columns;
         info.index = row.index;
         info.type_id = row.type_id;
-        EcsArray *to_remove = ecs_type_get(world, stage, type);
-        dst_type = ecs_type_merge_arr(world, stage, info.table->type, NULL, to_remove);
+        dst_type = ecs_table_traverse_remove(world, stage, info.table, type);
     } else if (!world->in_progress) {
         return EcsOk;
     }
@@ -792,6 +1275,22 @@ EcsResult _ecs_remove(
     return commit_w_type(world, stage, &info, dst_type, 0, type);
 }
 
+void _ecs_add_w_filter(
+    EcsWorld *world,
+    EcsType type,
+    EcsType filter)
+{
+    commit_w_filter(world, type, filter, true);
+}
+
+void _ecs_remove_w_filter(
+    EcsWorld *world,
+    EcsType type,
+    EcsType filter)
+{
+    commit_w_filter(world, type, filter, false);
+}
+
 EcsResult ecs_adopt(
     EcsWorld *world,
     EcsEntity parent,
@@ -836,6 +1335,35 @@ void* _ecs_get_ptr(
     return get_ptr(world, entity, component, false, true, &info);
 }
 
+void* _ecs_get_ref(
+    EcsWorld *world,
+    EcsRef *ref,
+    EcsEntity entity,
+    EcsType type)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(ref != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    EcsWorld *real_world = world;
+    ecs_get_stage(&real_world);
+
+    /* Staged components only exist until the next merge, don't cache them */
+    if (real_world->in_progress) {
+        return _ecs_get_ptr(world, entity, type);
+    }
+
+    if (ref->entity == entity && ref->component == type && 
+        ref_is_valid(real_world, ref)) 
+    {
+        return ref->ptr;
+    }
+
+    ref->entity = entity;
+    ref->component = type;
+
+    return resolve_ref(real_world, ref);
+}
+
 static
 EcsEntity _ecs_set_ptr_intern(
     EcsWorld *world,
@@ -874,9 +1402,22 @@ EcsEntity _ecs_set_ptr_intern(
 
     memcpy(dst, ptr, size);
 
+    EcsWorld *real_world = world;
+    ecs_get_stage(&real_world);
+
+    /* Mark column as changed. If the entity is staged, the column of the main
+     * stage is marked when the entity is merged. */
+    int16_t column_index = ecs_table_column_index(info.table, component);
+    if (column_index != -1) {
+        info.columns[column_index + 1].version = real_world->change_version;
+    }
+
+    if (component == EEcsId) {
+        ecs_world_register_name(real_world, entity, *(EcsId*)ptr);
+    }
+
     notify_pre_merge(
-        world, info.table, info.columns, info.index, 1, type,
-        world->type_sys_set_index);
+        world, info.table, info.columns, info.index, 1, type, EcsOnSet);
 
     return entity;
 }
@@ -937,7 +1478,7 @@ bool _ecs_has_any(
 
     EcsStage *stage = ecs_get_stage(&world);
     EcsType entity_type = ecs_typeid(world, entity);
-    return ecs_type_contains(world, stage, entity_type, type, false, true);
+    return ecs_type_contains(world, stage, entity_type, type, false, true) != 0;
 }
 
 bool ecs_contains(
@@ -993,15 +1534,13 @@ bool ecs_empty(
 {
     ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
 
-    uint64_t cur64 = ecs_map_get64(world->main_stage.entity_index, entity);
+    EcsStage *stage = ecs_get_stage(&world);
+    EcsRow cur = ecs_entity_index_get(world->entity_index, entity);
 
     if (world->in_progress) {
-        EcsStage *stage = ecs_get_stage(&world);
-
         uint64_t to_add64 = ecs_map_get64(stage->entity_index, entity);
         uint64_t to_remove64 = ecs_map_get64(stage->remove_merge, entity);
 
-        EcsRow cur = ecs_to_row(cur64);
         EcsRow to_add = ecs_to_row(to_add64);
         EcsRow to_remove = ecs_to_row(to_remove64);
         EcsType result = ecs_type_merge(world, stage, 
@@ -1009,10 +1548,26 @@ bool ecs_empty(
 
         return result == 0;   
     } else {
-        return cur64 == 0;
+        return cur.type_id == 0;
     }
 }
 
+bool ecs_is_alive(
+    EcsWorld *world,
+    EcsEntity entity)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    ecs_get_stage(&world);
+
+    EcsEntity id = entity & ECS_ENTITY_MASK;
+    if (!id || id > world->last_handle) {
+        return false;
+    }
+
+    return ecs_entity_index_is_alive(world->entity_index, entity);
+}
+
 EcsEntity ecs_get_component(
     EcsWorld *world,
     EcsEntity entity,
@@ -1021,14 +1576,13 @@ EcsEntity ecs_get_component(
     ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
 
     EcsStage *stage = ecs_get_stage(&world);
-    int64_t row64 = ecs_map_get64(stage->entity_index, entity);
+    EcsRow row = get_row(world, stage, entity);
 
-    if (!row64) {
+    if (!row.type_id) {
         return 0;
     }
 
-    EcsRow row = ecs_to_row(row64);
-    EcsArray *components = ecs_map_get(stage->type_index, row.type_id);
+    EcsArray *components = ecs_type_get(world, stage, row.type_id);
     EcsEntity *buffer = ecs_array_buffer(components);
 
     if (ecs_array_count(components) > index) {
@@ -1054,7 +1608,9 @@ EcsEntity ecs_entity_from_type(
 {
     ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
 
-    EcsArray *type = ecs_map_get(world->main_stage.type_index, type_id);
+    ecs_get_stage(&world);
+
+    EcsArray *type = ecs_type_get(world, NULL, type_id);
     if (!type) {
         ecs_abort(ECS_UNKNOWN_TYPE_ID, NULL);
     }
@@ -1073,14 +1629,12 @@ EcsType ecs_typeid(
 {
     ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
     EcsStage *stage = ecs_get_stage(&world);
-    int64_t row64 = ecs_map_get64(stage->entity_index, entity);
-    EcsRow row = ecs_to_row(row64);
+    EcsRow row = get_row(world, stage, entity);
     EcsType result = row.type_id;
 
     if (world->in_progress) {
-        int64_t main_row64 = ecs_map_get64(world->main_stage.entity_index, entity);
+        EcsRow main_row = ecs_entity_index_get(world->entity_index, entity);
         EcsType remove_type = ecs_map_get64(stage->remove_merge, entity);
-        EcsRow main_row = ecs_to_row(main_row64);
         result = ecs_type_merge(world, stage, main_row.type_id, result, remove_type);
     }
     
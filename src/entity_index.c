@@ -0,0 +1,243 @@
+#include <string.h>
+#include "include/private/flecs.h"
+
+/** The entity index stores the rows of the entities in the main stage. Because
+ * entity ids are handed out sequentially, the index is a dense array that is
+ * indexed directly by entity id. The array is split up in pages which are
+ * allocated the first time an entity in their range is stored, so that a
+ * lookup costs two loads (page, then row) and growing the index never moves
+ * existing rows.
+ *
+ * Each slot also stores the generation of the id. When an entity is deleted,
+ * the generation is increased and the id is added to a list of free ids, so
+ * that it can be recycled. Handles with an old generation no longer resolve to
+ * a row, which makes stale handles cheap to detect. */
+typedef struct EcsEntitySlot {
+    EcsRow row;             /* Table and index of entity */
+    uint32_t generation;    /* Generation of the id stored in this slot */
+} EcsEntitySlot;
+
+struct EcsEntityIndex {
+    EcsArray *pages;        /* Array with pointers to pages */
+    EcsArray *free_ids;     /* Deleted ids that can be recycled */
+    uint32_t count;         /* Number of entities in index */
+};
+
+#define PAGE_INDEX(entity) (((entity) & ECS_ENTITY_MASK) / ECS_ENTITY_PAGE_SIZE)
+#define PAGE_OFFSET(entity) (((entity) & ECS_ENTITY_MASK) % ECS_ENTITY_PAGE_SIZE)
+
+static
+const EcsArrayParams page_arr_params = {
+    .element_size = sizeof(EcsEntitySlot*)
+};
+
+/** Get page for entity, optionally allocate it if it doesn't exist yet */
+static
+EcsEntitySlot* get_page(
+    EcsEntityIndex *index,
+    uint64_t page_index,
+    bool create)
+{
+    uint32_t count = ecs_array_count(index->pages);
+
+    if (page_index >= count) {
+        if (!create) {
+            return NULL;
+        }
+
+        ecs_array_set_count(&index->pages, &page_arr_params, page_index + 1);
+        EcsEntitySlot **buffer = ecs_array_buffer(index->pages);
+        memset(&buffer[count], 0, 
+            (page_index + 1 - count) * sizeof(EcsEntitySlot*));
+    }
+
+    EcsEntitySlot **pages = ecs_array_buffer(index->pages);
+    EcsEntitySlot *page = pages[page_index];
+
+    if (!page && create) {
+        page = calloc(ECS_ENTITY_PAGE_SIZE, sizeof(EcsEntitySlot));
+        ecs_assert(page != NULL, ECS_OUT_OF_MEMORY, NULL);
+        pages[page_index] = page;
+    }
+
+    return page;
+}
+
+/** Get slot for entity, optionally allocate its page */
+static
+EcsEntitySlot* get_slot(
+    EcsEntityIndex *index,
+    EcsEntity entity,
+    bool create)
+{
+    EcsEntitySlot *page = get_page(index, PAGE_INDEX(entity), create);
+    if (page) {
+        return &page[PAGE_OFFSET(entity)];
+    } else {
+        return NULL;
+    }
+}
+
+/* -- Private functions -- */
+
+EcsEntityIndex* ecs_entity_index_new(void)
+{
+    EcsEntityIndex *result = malloc(sizeof(EcsEntityIndex));
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    result->pages = ecs_array_new(&page_arr_params, 0);
+    result->free_ids = ecs_array_new(&handle_arr_params, 0);
+    result->count = 0;
+
+    return result;
+}
+
+void ecs_entity_index_free(
+    EcsEntityIndex *index)
+{
+    EcsEntitySlot **pages = ecs_array_buffer(index->pages);
+    uint32_t i, count = ecs_array_count(index->pages);
+
+    for (i = 0; i < count; i ++) {
+        free(pages[i]);
+    }
+
+    ecs_array_free(index->pages);
+    ecs_array_free(index->free_ids);
+    free(index);
+}
+
+EcsRow ecs_entity_index_get(
+    EcsEntityIndex *index,
+    EcsEntity entity)
+{
+    EcsEntitySlot *slot = get_slot(index, entity, false);
+    if (slot && slot->generation == ECS_GENERATION(entity)) {
+        return slot->row;
+    } else {
+        return (EcsRow){0, 0};
+    }
+}
+
+void ecs_entity_index_set(
+    EcsEntityIndex *index,
+    EcsEntity entity,
+    EcsRow row)
+{
+    ecs_assert(row.type_id != 0, ECS_INTERNAL_ERROR, NULL);
+
+    EcsEntitySlot *slot = get_slot(index, entity, true);
+    ecs_assert(slot->generation == ECS_GENERATION(entity), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    if (!slot->row.type_id) {
+        index->count ++;
+    }
+
+    slot->row = row;
+}
+
+void ecs_entity_index_remove(
+    EcsEntityIndex *index,
+    EcsEntity entity)
+{
+    EcsEntitySlot *slot = get_slot(index, entity, false);
+    if (slot && slot->generation == ECS_GENERATION(entity)) {
+        if (slot->row.type_id) {
+            index->count --;
+            slot->row = (EcsRow){0, 0};
+        }
+    }
+}
+
+bool ecs_entity_index_is_alive(
+    EcsEntityIndex *index,
+    EcsEntity entity)
+{
+    EcsEntitySlot *slot = get_slot(index, entity, false);
+    if (slot) {
+        return slot->generation == ECS_GENERATION(entity);
+    } else {
+        /* Ids in pages that have not been allocated are in generation 0 */
+        return ECS_GENERATION(entity) == 0;
+    }
+}
+
+void ecs_entity_index_delete(
+    EcsEntityIndex *index,
+    EcsEntity entity)
+{
+    EcsEntitySlot *slot = get_slot(index, entity, true);
+    ecs_assert(slot->generation == ECS_GENERATION(entity), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    if (slot->row.type_id) {
+        index->count --;
+        slot->row = (EcsRow){0, 0};
+    }
+
+    slot->generation ++;
+
+    EcsEntity *elem = ecs_array_add(&index->free_ids, &handle_arr_params);
+    *elem = (entity & ECS_ENTITY_MASK) | 
+        ((uint64_t)slot->generation << 32);
+}
+
+EcsEntity ecs_entity_index_recycle(
+    EcsEntityIndex *index)
+{
+    uint32_t count = ecs_array_count(index->free_ids);
+    if (!count) {
+        return 0;
+    }
+
+    EcsEntity *buffer = ecs_array_buffer(index->free_ids);
+    EcsEntity result = buffer[count - 1];
+    ecs_array_remove_last(index->free_ids);
+
+    return result;
+}
+
+uint32_t ecs_entity_index_count(
+    EcsEntityIndex *index)
+{
+    return index->count;
+}
+
+void ecs_entity_index_set_size(
+    EcsEntityIndex *index,
+    EcsEntity first,
+    uint32_t count)
+{
+    if (!count) {
+        return;
+    }
+
+    /* The last entity is first + count - 1, don't allocate the page after */
+    uint64_t i, last = PAGE_INDEX(first + count - 1);
+    for (i = PAGE_INDEX(first); i <= last; i ++) {
+        get_page(index, i, true);
+    }
+}
+
+void ecs_entity_index_memory(
+    EcsEntityIndex *index,
+    uint32_t *allocd,
+    uint32_t *used)
+{
+    EcsEntitySlot **pages = ecs_array_buffer(index->pages);
+    uint32_t i, count = ecs_array_count(index->pages);
+
+    ecs_array_memory(index->pages, &page_arr_params, allocd, used);
+    ecs_array_memory(index->free_ids, &handle_arr_params, allocd, used);
+
+    for (i = 0; i < count; i ++) {
+        if (pages[i] && allocd) {
+            *allocd += ECS_ENTITY_PAGE_SIZE * sizeof(EcsEntitySlot);
+        }
+    }
+
+    if (used) {
+        *used += index->count * sizeof(EcsEntitySlot);
+    }
+}
@@ -1,193 +1,258 @@
-#include <assert.h>
+#include <string.h>
 #include "include/private/types.h"
 
-#define FLECS_LOAD_FACTOR (3.0f / 4.0f)
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-typedef struct EcsMapNode {
+/* The map is an open addressing hash table. Each slot has a control byte that
+ * indicates whether the slot is empty, deleted or full. For full slots, the
+ * control byte stores the lower 7 bits of the hash (h2), while the remaining
+ * bits (h1) select the group of slots where probing starts. A lookup compares
+ * h2 against the control bytes of a group of 16 slots at once (with SSE2 when
+ * available), and only compares keys of slots that matched. Probing stops at
+ * the first group that has an empty slot. */
+
+#define FLECS_LOAD_FACTOR (7.0f / 8.0f)
+#define GROUP_SIZE (16)
+
+#define CTRL_EMPTY ((int8_t)-128)     /* 0b10000000 */
+#define CTRL_DELETED ((int8_t)-2)     /* 0b11111110 */
+
+typedef struct EcsMapSlot {
     uint64_t key;           /* Key */
     uint64_t data;          /* Value */
-    uint32_t next;          /* Next node index */
-    uint32_t prev;          /* Previous node index (enables O(1) removal) */
-} EcsMapNode;
+} EcsMapSlot;
 
 struct EcsMap {
-    uint32_t *buckets;      /* Array of buckets */
-    EcsArray *nodes;        /* Array with memory for map nodes */
-    size_t bucket_count;    /* number of buckets */
-    uint32_t count;         /* number of elements */
-    uint32_t min;           /* minimum number of elements */
+    int8_t *ctrl;           /* Control bytes, one for each slot */
+    EcsMapSlot *slots;      /* Keys and values */
+    uint32_t bucket_count;  /* Number of slots (power of two) */
+    uint32_t count;         /* Number of elements */
+    uint32_t deleted;       /* Number of deleted slots (tombstones) */
 };
 
+/** Mix bits of key, so that sequential keys spread out over groups */
 static
-void move_node(
-    EcsArray *array,
-    const EcsArrayParams *params,
-    void *to,
-    void *from,
-    void *ctx);
-
-const EcsArrayParams node_arr_params = {
-    .element_size = sizeof(EcsMapNode),
-    .move_action = move_node
-};
+uint64_t hash_key(
+    uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
 
-/** Get map node from index */
+/** Index of lowest bit set in mask */
 static
-EcsMapNode *node_from_index(
-    EcsArray *nodes,
-    uint32_t index)
+uint32_t first_bit(
+    uint32_t mask)
 {
-    return ecs_array_get(nodes, &node_arr_params, index - 1);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    uint32_t result = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        result ++;
+    }
+    return result;
+#endif
 }
 
-/** Get a bucket for a given key */
+/** Return bitmask of slots in group whose control byte equals value */
 static
-uint32_t* get_bucket(
-    EcsMap *map,
-    uint64_t key)
+uint32_t group_match(
+    const int8_t *group,
+    int8_t value)
 {
-    uint64_t index = key % map->bucket_count;
-    return &map->buckets[index];
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value)));
+#else
+    uint32_t i, result = 0;
+    for (i = 0; i < GROUP_SIZE; i ++) {
+        result |= (uint32_t)(group[i] == value) << i;
+    }
+    return result;
+#endif
 }
 
-/** Callback that updates administration when node is moved in nodes array */
+/** Return bitmask of slots in group that are empty or deleted */
 static
-void move_node(
-    EcsArray *array,
-    const EcsArrayParams *params,
-    void *to,
-    void *from,
-    void *ctx)
+uint32_t group_match_free(
+    const int8_t *group)
 {
-    EcsMapNode *node_p = to;
-    uint32_t node = ecs_array_get_index(array, &node_arr_params, to) + 1;
-    uint32_t prev = node_p->prev;
-    uint32_t next = node_p->next;
-
-    if (prev) {
-        EcsMapNode *prev_p = node_from_index(array, prev);
-        prev_p->next = node;
-    } else {
-        EcsMap *map = ctx;
-        uint32_t *bucket = get_bucket(map, node_p->key);
-        *bucket = node;
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return _mm_movemask_epi8(ctrl);
+#else
+    uint32_t i, result = 0;
+    for (i = 0; i < GROUP_SIZE; i ++) {
+        result |= (uint32_t)(group[i] < 0) << i;
     }
+    return result;
+#endif
+}
 
-    if (next) {
-        EcsMapNode *next_p = node_from_index(array, next);
-        next_p->prev = node;
+/** Number of elements map can hold before it needs to grow */
+static
+uint32_t growth_limit(
+    uint32_t bucket_count)
+{
+    return bucket_count * FLECS_LOAD_FACTOR;
+}
+
+/** Compute number of slots required to store count elements */
+static
+uint32_t slots_for_count(
+    uint32_t count)
+{
+    uint32_t result = GROUP_SIZE;
+
+    if (!count) {
+        return 0;
     }
+
+    while (growth_limit(result) < count) {
+        result *= 2;
+    }
+
+    return result;
 }
 
-/** Allocate the buckets buffer */
+/** Allocate buffers for number of slots */
 static
 void alloc_buffer(
     EcsMap *map,
     uint32_t bucket_count)
 {
     if (bucket_count) {
-        map->buckets = calloc(bucket_count * sizeof(uint32_t), 1);
-        ecs_assert(map->buckets != NULL, ECS_OUT_OF_MEMORY, 0);
+        map->ctrl = malloc(bucket_count);
+        ecs_assert(map->ctrl != NULL, ECS_OUT_OF_MEMORY, 0);
+        memset(map->ctrl, CTRL_EMPTY, bucket_count);
+
+        map->slots = malloc(bucket_count * sizeof(EcsMapSlot));
+        ecs_assert(map->slots != NULL, ECS_OUT_OF_MEMORY, 0);
     } else {
-        map->buckets = NULL;
+        map->ctrl = NULL;
+        map->slots = NULL;
     }
 
     map->bucket_count = bucket_count;
+    map->deleted = 0;
 }
 
-/** Allocate a map object */
+/** Find slot for key. Returns -1 if key is not in map. */
 static
-EcsMap *alloc_map(
-    uint32_t bucket_count)
-{
-    EcsMap *result = malloc(sizeof(EcsMap));
-    alloc_buffer(result, bucket_count);
-    result->count = 0;
-    result->min = bucket_count;
-    result->nodes = ecs_array_new(&node_arr_params, ECS_MAP_INITIAL_NODE_COUNT);
-    return result;
-}
-
-/** Find next non-empty bucket */
-static
-uint32_t next_bucket(
+int32_t find_slot(
     EcsMap *map,
-    uint32_t start_index)
+    uint64_t key)
 {
-    int i;
-    for (i = start_index; i < map->bucket_count; i ++) {
-        if (map->buckets[i]) {
-            break;
+    uint64_t hash = hash_key(key);
+    int8_t h2 = hash & 0x7F;
+    uint32_t group_mask = (map->bucket_count / GROUP_SIZE) - 1;
+    uint32_t group = (hash >> 7) & group_mask;
+    uint32_t stride = 0;
+
+    do {
+        const int8_t *ctrl = &map->ctrl[group * GROUP_SIZE];
+        uint32_t match = group_match(ctrl, h2);
+
+        while (match) {
+            uint32_t slot = group * GROUP_SIZE + first_bit(match);
+            if (map->slots[slot].key == key) {
+                return slot;
+            }
+            match &= match - 1;
         }
-    }
 
-    return i;
+        if (group_match(ctrl, CTRL_EMPTY)) {
+            return -1;
+        }
+
+        /* Triangular probing visits every group once */
+        stride ++;
+        group = (group + stride) & group_mask;
+    } while (stride <= group_mask);
+
+    return -1;
 }
 
-/** Add new node to bucket */
+/** Insert key that is not yet in map, without checking the load factor */
 static
-void add_node(
+EcsMapSlot* insert_slot(
     EcsMap *map,
-    uint32_t *bucket,
-    uint64_t key,
-    uint64_t data,
-    EcsMapNode *elem_p)
+    uint64_t key)
 {
-    uint32_t elem;
-
-    if (!elem_p) {
-        elem_p = ecs_array_add(&map->nodes, &node_arr_params);
-        elem = ecs_array_count(map->nodes);
-    } else {
-        elem = ecs_array_get_index(
-            map->nodes,
-            &node_arr_params,
-            elem_p) + 1;
+    uint64_t hash = hash_key(key);
+    uint32_t group_mask = (map->bucket_count / GROUP_SIZE) - 1;
+    uint32_t group = (hash >> 7) & group_mask;
+    uint32_t stride = 0;
+    uint32_t match;
+
+    while (!(match = group_match_free(&map->ctrl[group * GROUP_SIZE]))) {
+        stride ++;
+        group = (group + stride) & group_mask;
+        ecs_assert(stride <= group_mask, ECS_INTERNAL_ERROR, NULL);
     }
 
-    elem_p->key = key;
-    elem_p->data = data;
-    elem_p->next = 0;
-    elem_p->prev = 0;
-
-    uint32_t first = *bucket;
-    if (first) {
-        EcsMapNode *first_p = node_from_index(map->nodes, first);
-        first_p->prev = elem;
-        elem_p->next = first;
+    uint32_t slot = group * GROUP_SIZE + first_bit(match);
+    if (map->ctrl[slot] == CTRL_DELETED) {
+        map->deleted --;
     }
 
-    *bucket = elem;
-
+    map->ctrl[slot] = hash & 0x7F;
     map->count ++;
+
+    EcsMapSlot *result = &map->slots[slot];
+    result->key = key;
+    return result;
 }
 
-/** Get map node for a given key */
+/** Rehash all elements into a buffer with the specified number of slots */
 static
-EcsMapNode *get_node(
+void resize_map(
     EcsMap *map,
-    uint32_t *bucket,
-    uint64_t key)
+    uint32_t bucket_count)
 {
-    uint32_t node = *bucket;
+    int8_t *old_ctrl = map->ctrl;
+    EcsMapSlot *old_slots = map->slots;
+    uint32_t i, old_bucket_count = map->bucket_count;
 
-    while (node) {
-        EcsMapNode *node_p = node_from_index(map->nodes, node);
+    alloc_buffer(map, bucket_count);
+    map->count = 0;
 
-        if (node_p->prev) {
-            assert(node_from_index(map->nodes, node_p->prev)->next == node);
-        }
-        if (node_p->next) {
-            assert(node_from_index(map->nodes, node_p->next)->prev == node);
+    for (i = 0; i < old_bucket_count; i ++) {
+        if (old_ctrl[i] >= 0) {
+            EcsMapSlot *slot = insert_slot(map, old_slots[i].key);
+            slot->data = old_slots[i].data;
         }
+    }
+
+    free(old_ctrl);
+    free(old_slots);
+}
 
-        if (node_p->key == key) {
-            return node_p;
+/** Make room for one more element */
+static
+void grow_map(
+    EcsMap *map)
+{
+    uint32_t bucket_count = map->bucket_count;
+
+    if (!bucket_count) {
+        resize_map(map, GROUP_SIZE);
+    } else if (map->count + map->deleted + 1 > growth_limit(bucket_count)) {
+        /* If the map mostly consists of tombstones, rehashing in place is
+         * enough to make room for new elements */
+        if (map->count + 1 > growth_limit(bucket_count) / 2) {
+            bucket_count *= 2;
         }
-        node = node_p->next;
+        resize_map(map, bucket_count);
     }
-
-    return NULL;
 }
 
 /** Iterator hasnext callback */
@@ -201,35 +266,18 @@ bool hasnext(
         return false;
     }
 
-    if (!map->buckets) {
-        return false;
-    }
-
     EcsMapIter *iter_data = iter->ctx;
-    uint32_t bucket_index = iter_data->bucket_index;
-    uint32_t node = iter_data->node;
-
-    if (node) {
-        EcsMapNode *node_p = node_from_index(map->nodes, node);
-        node = node_p->next;
-    }
+    uint32_t index = iter_data->index + 1;
 
-    if (!node) {
-        bucket_index = next_bucket(map, bucket_index + 1);
-        if (bucket_index < map->bucket_count) {
-            node = map->buckets[bucket_index];
-        } else {
-            node = 0;
+    for (; index < map->bucket_count; index ++) {
+        if (map->ctrl[index] >= 0) {
+            iter_data->index = index;
+            return true;
         }
     }
 
-    if (node) {
-        iter_data->node = node;
-        iter_data->bucket_index = bucket_index;
-        return true;
-    } else {
-        return false;
-    }
+    iter_data->index = index;
+    return false;
 }
 
 /** Map-specific next functionality that returns keys and 64bit data */
@@ -240,10 +288,9 @@ uint64_t next_w_key(
 {
     EcsMap *map = iter->data;
     EcsMapIter *iter_data = iter->ctx;
-    EcsMapNode *node_p = node_from_index(map->nodes, iter_data->node);
-    assert(node_p != NULL);
-    if (key_out) *key_out = node_p->key;
-    return node_p->data;
+    EcsMapSlot *slot = &map->slots[iter_data->index];
+    if (key_out) *key_out = slot->key;
+    return slot->data;
 }
 
 /** Iterator next callback */
@@ -254,79 +301,37 @@ void *next(
     return (void*)next_w_key(iter, NULL);
 }
 
-/** Resize number of buckets in a map */
-static
-void resize_map(
-    EcsMap *map,
-    uint32_t bucket_count)
-{
-    uint32_t *old_buckets = map->buckets;
-    uint32_t old_bucket_count = map->bucket_count;
-
-    alloc_buffer(map, bucket_count);
-    map->count = 0;
-
-    uint32_t bucket_index;
-    for (bucket_index = 0; bucket_index < old_bucket_count; bucket_index ++) {
-        uint32_t bucket = old_buckets[bucket_index];
-        if (bucket) {
-            uint32_t node = bucket;
-            uint32_t next;
-            uint64_t key;
-
-            EcsMapNode *node_p;
-            do {
-                node_p = node_from_index(map->nodes, node);
-                next = node_p->next;
-                key = node_p->key;
-                uint32_t *new_bucket = get_bucket(map, key);
-                add_node(map, new_bucket, key, node_p->data, node_p);
-            } while ((node = next));
-        }
-    }
-
-    free(old_buckets);
-}
-
 
 /* -- Public functions -- */
 
 EcsMap* ecs_map_new(
     uint32_t size)
 {
-    return alloc_map((float)size / FLECS_LOAD_FACTOR);
+    EcsMap *result = malloc(sizeof(EcsMap));
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
+    alloc_buffer(result, slots_for_count(size));
+    result->count = 0;
+    return result;
 }
 
 void ecs_map_clear(
     EcsMap *map)
 {
-    uint32_t target_size = (float)map->count / FLECS_LOAD_FACTOR;
-
-    if (target_size < map->min) {
-        target_size = map->min;
+    /* Keep the buffers, as maps are typically cleared to be filled again with
+     * a similar number of elements */
+    if (map->count || map->deleted) {
+        memset(map->ctrl, CTRL_EMPTY, map->bucket_count);
     }
 
-    if (target_size < (float)map->bucket_count * 0.75) {
-        free(map->buckets);
-        alloc_buffer(map, target_size);
-    } else {
-        int i;
-        for (i = 0; i < map->bucket_count; i ++) {
-            map->buckets[i] = 0;
-        }
-    }
-
-    ecs_array_reclaim(&map->nodes, &node_arr_params);
-    ecs_array_clear(map->nodes);
-
     map->count = 0;
+    map->deleted = 0;
 }
 
 void ecs_map_free(
     EcsMap *map)
 {
-    ecs_array_free(map->nodes);
-    free(map->buckets);
+    free(map->ctrl);
+    free(map->slots);
     free(map);
 }
 
@@ -335,28 +340,16 @@ void ecs_map_set64(
     uint64_t key,
     uint64_t data)
 {
-    uint32_t bucket_count = map->bucket_count;
-    if (!bucket_count) {
-        alloc_buffer(map, 2);
-        bucket_count = map->bucket_count;
-    }
-
-    uint32_t *bucket = get_bucket(map, key);
-
-    if (!*bucket) {
-        add_node(map, bucket, key, data, NULL);
-    } else {
-        EcsMapNode *elem = get_node(map, bucket, key);
-        if (elem) {
-            elem->data = data;
-        } else {
-            add_node(map, bucket, key, data, NULL);
+    if (map->count) {
+        int32_t slot = find_slot(map, key);
+        if (slot != -1) {
+            map->slots[slot].data = data;
+            return;
         }
     }
 
-    if ((float)map->count / (float)bucket_count > FLECS_LOAD_FACTOR) {
-        resize_map(map, bucket_count * 2);
-    }
+    grow_map(map);
+    insert_slot(map, key)->data = data;
 }
 
 EcsResult ecs_map_remove(
@@ -367,37 +360,24 @@ EcsResult ecs_map_remove(
         return EcsError;
     }
 
-    uint32_t *bucket = get_bucket(map, key);
-
-    if (*bucket) {
-        EcsMapNode *node = get_node(map, bucket, key);
-        if (node) {
-            EcsMapNode *prev_node = node_from_index(map->nodes, node->prev);
-            EcsMapNode *next_node = node_from_index(map->nodes, node->next);
-
-            if (prev_node) {
-                assert(node_from_index(map->nodes, prev_node->next) == node);
-                prev_node->next = node->next;
-            } else {
-                *bucket = node->next;
-            }
-
-            if (next_node) {
-                assert(node_from_index(map->nodes, next_node->prev) == node);
-                next_node->prev = node->prev;
-            }
-
-            EcsArrayParams params = node_arr_params;
-            params.move_ctx = map;
-
-            ecs_array_remove(map->nodes, &params, node);
-            map->count --;
+    int32_t slot = find_slot(map, key);
+    if (slot == -1) {
+        return EcsError;
+    }
 
-            return EcsOk;
-        }
+    /* If the group still has an empty slot, no probe sequence has ever moved
+     * past it, and the slot can be marked empty instead of deleted. */
+    int8_t *group = &map->ctrl[slot - slot % GROUP_SIZE];
+    if (group_match(group, CTRL_EMPTY)) {
+        map->ctrl[slot] = CTRL_EMPTY;
+    } else {
+        map->ctrl[slot] = CTRL_DELETED;
+        map->deleted ++;
     }
 
-    return EcsError;
+    map->count --;
+
+    return EcsOk;
 }
 
 uint64_t ecs_map_get64(
@@ -408,12 +388,9 @@ uint64_t ecs_map_get64(
         return 0;
     }
 
-    uint32_t *bucket = get_bucket(map, key);
-    if (*bucket) {
-        EcsMapNode *elem = get_node(map, bucket, key);
-        if (elem) {
-            return elem->data;
-        }
+    int32_t slot = find_slot(map, key);
+    if (slot != -1) {
+        return map->slots[slot].data;
     }
 
     return 0;
@@ -428,15 +405,12 @@ bool ecs_map_has(
         return false;
     }
 
-    uint32_t *bucket = get_bucket(map, key_hash);
-    if (*bucket) {
-        EcsMapNode *elem = get_node(map, bucket, key_hash);
-        if (elem) {
-            if (value_out) {
-                *value_out = elem->data;
-            }
-            return true;
+    int32_t slot = find_slot(map, key_hash);
+    if (slot != -1) {
+        if (value_out) {
+            *value_out = map->slots[slot].data;
         }
+        return true;
     }
 
     return false;
@@ -458,9 +432,12 @@ uint32_t ecs_map_set_size(
     EcsMap *map,
     uint32_t size)
 {
-    uint32_t result = ecs_array_set_size(&map->nodes, &node_arr_params, size);
-    resize_map(map, size / FLECS_LOAD_FACTOR);
-    return result;
+    uint32_t bucket_count = slots_for_count(size);
+    if (bucket_count > map->bucket_count) {
+        resize_map(map, bucket_count);
+    }
+
+    return growth_limit(map->bucket_count);
 }
 
 EcsIter _ecs_map_iter(
@@ -475,8 +452,7 @@ EcsIter _ecs_map_iter(
         .release = NULL
     };
 
-    iter_data->bucket_index = -1;
-    iter_data->node = 0;
+    iter_data->index = -1;
 
     return result;
 }
@@ -498,13 +474,10 @@ void ecs_map_memory(
     }
 
     if (total) {
-
-        *total += map->bucket_count * sizeof(uint32_t) + sizeof(EcsMap);
-        ecs_array_memory(map->nodes, &node_arr_params, total, NULL);
+        *total += map->bucket_count * (sizeof(EcsMapSlot) + 1) + sizeof(EcsMap);
     }
 
     if (used) {
-        *used += map->count * sizeof(uint32_t);
-        ecs_array_memory(map->nodes, &node_arr_params, NULL, used);
+        *used += map->count * (sizeof(EcsMapSlot) + 1);
     }
 }
@@ -13,14 +13,47 @@ const char *skip_space(
     return ptr;
 }
 
+/** Parse access modifier of element ('[in] Foo') */
+static
+char* parse_inout(
+    char *bptr,
+    EcsSystemExprInOutKind *inout_kind)
+{
+    char *end = strchr(bptr, ']');
+    if (!end) {
+        return NULL;
+    }
+
+    size_t len = end - bptr - 1;
+    if (len == 2 && !strncmp(bptr + 1, "in", len)) {
+        *inout_kind = EcsIn;
+    } else if (len == 3 && !strncmp(bptr + 1, "out", len)) {
+        *inout_kind = EcsOut;
+    } else if (len == 5 && !strncmp(bptr + 1, "inout", len)) {
+        *inout_kind = EcsInOut;
+    } else {
+        return NULL;
+    }
+
+    return end + 1;
+}
+
 /** Parse element with a dot-separated qualifier ('CONTAINER.Foo') */
 static
 char* parse_complex_elem(
     char *bptr,
     EcsSystemExprElemKind *elem_kind,
     EcsSystemExprOperKind *oper_kind,
+    EcsSystemExprInOutKind *inout_kind,
     const char * *source)
 {
+    if (bptr[0] == '[') {
+        bptr = parse_inout(bptr, inout_kind);
+        if (!bptr || !bptr[0]) {
+            return NULL;
+        }
+    }
+
     if (bptr[0] == '!') {
         *oper_kind = EcsOperNot;
         if (!bptr[1]) {
@@ -72,6 +105,7 @@ EcsResult has_tables(
     EcsWorld *world,
     EcsSystemExprElemKind elem_kind,
     EcsSystemExprOperKind oper_kind,
+    EcsSystemExprInOutKind inout_kind,
     const char *component_id,
     const char *source_id,
     void *data)
@@ -123,6 +157,7 @@ EcsResult ecs_parse_component_expr(
     bool complex_expr = false;
     EcsSystemExprElemKind elem_kind = EcsFromSelf;
     EcsSystemExprOperKind oper_kind = EcsOperAnd;
+    EcsSystemExprInOutKind inout_kind = EcsInOut;
     const char *source;
 
     for (bptr = buffer, ch = sig[0], ptr = sig; ch; ptr++) {
@@ -140,7 +175,8 @@ EcsResult ecs_parse_component_expr(
             source = NULL;
 
             if (complex_expr) {
-                bptr = parse_complex_elem(bptr, &elem_kind, &oper_kind, &source);
+                bptr = parse_complex_elem(
+                    bptr, &elem_kind, &oper_kind, &inout_kind, &source);
                 if (!bptr) {
                     ecs_abort(ECS_INVALID_COMPONENT_EXPRESSION, sig);
                 }
@@ -173,7 +209,9 @@ EcsResult ecs_parse_component_expr(
                 source_id[dot - source] = '\0';
             }
 
-            if (action(world, elem_kind, oper_kind, bptr, source_id, ctx) != EcsOk) {
+            if (action(world, elem_kind, oper_kind, inout_kind, bptr, source_id, 
+                ctx) != EcsOk) 
+            {
                 ecs_abort(ECS_INVALID_COMPONENT_EXPRESSION, sig);
             }
 
@@ -183,6 +221,7 @@ EcsResult ecs_parse_component_expr(
 
             complex_expr = false;
             elem_kind = EcsFromSelf;
+            inout_kind = EcsInOut;
 
             if (ch == '|') {
                 if (elem_kind == EcsFromId) {
@@ -199,7 +238,7 @@ EcsResult ecs_parse_component_expr(
             *bptr = ch;
             bptr ++;
 
-            if (ch == '.' || ch == '!' || ch == '?' || ch == '$') {
+            if (ch == '.' || ch == '!' || ch == '?' || ch == '$' || ch == '[') {
                 complex_expr = true;
             }
         }
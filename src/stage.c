@@ -2,24 +2,6 @@
 #include "include/private/flecs.h"
 #include <string.h>
 
-static
-void merge_families(
-    EcsWorld *world,
-    EcsStage *stage)
-{
-    EcsIter it = ecs_map_iter(stage->type_index);
-    while (ecs_iter_hasnext(&it)) {
-        uint64_t type_id;
-        EcsArray *type = (void*)(uintptr_t)ecs_map_next(&it, &type_id);
-
-        if (!ecs_map_has(world->main_stage.type_index, type_id, NULL)) {
-            ecs_map_set(world->main_stage.type_index, type_id, type);
-        }
-    }
-
-    ecs_map_clear(stage->type_index);
-}
-
 static
 void merge_tables(
     EcsWorld *world,
@@ -34,6 +16,10 @@ void merge_tables(
         EcsTable *table = &buffer[i];
         EcsType type_id = table->type_id;
 
+        if (!table->type) {
+            continue;
+        }
+
         /* Ensure table exists in main stage */
         EcsTable *main_table = ecs_world_get_table(
             world, main_stage, type_id);
@@ -41,10 +27,10 @@ void merge_tables(
         ecs_assert(main_table != NULL, ECS_INTERNAL_ERROR, NULL);
 
         ecs_table_deinit(world, table);
+        ecs_table_free(world, table);
     }
 
     ecs_array_clear(stage->tables);
-    ecs_map_clear(stage->table_index);
 }
 
 static
@@ -61,10 +47,20 @@ void merge_commits(
         ecs_merge_entity(world, stage, entity, &staged_row);
     }
 
+    /* Free staged columns. The map stores a column array per staged type. */
     it = ecs_map_iter(stage->data_stage);
     while (ecs_iter_hasnext(&it)) {
-        EcsArray *stage = ecs_iter_next(&it);
-        ecs_array_free(stage);
+        uint64_t type_id;
+        EcsTableColumn *columns = (EcsTableColumn*)(uintptr_t)
+            ecs_map_next(&it, &type_id);
+        EcsArray *type = ecs_type_get(world, stage, type_id);
+        uint32_t i, column_last = ecs_array_count(type) + 1;
+
+        for (i = 0; i < column_last; i ++) {
+            ecs_array_free(columns[i].data);
+        }
+
+        free(columns);
     }
 
     ecs_map_clear(stage->entity_index);
@@ -72,17 +68,30 @@ void merge_commits(
     ecs_map_clear(stage->data_stage);
 }
 
+/** Free ids of entities deleted while in progress, so they can be recycled. An
+ * entity that got new components after it was deleted is kept alive. */
 static
-void clean_families(
+void merge_deletes(
+    EcsWorld *world,
     EcsStage *stage)
 {
-    EcsIter it = ecs_map_iter(stage->type_index);
-    while (ecs_iter_hasnext(&it)) {
-        EcsArray *type = ecs_iter_next(&it);
-        ecs_array_free(type);
+    EcsEntity *buffer = ecs_array_buffer(stage->delete_stage);
+    uint32_t i, count = ecs_array_count(stage->delete_stage);
+
+    for (i = 0; i < count; i ++) {
+        EcsEntity entity = buffer[i];
+
+        if (!ecs_entity_index_is_alive(world->entity_index, entity)) {
+            continue;
+        }
+
+        EcsRow row = ecs_entity_index_get(world->entity_index, entity);
+        if (!row.type_id) {
+            ecs_entity_index_delete(world->entity_index, entity);
+        }
     }
 
-    ecs_map_free(stage->type_index);
+    ecs_array_clear(stage->delete_stage);
 }
 
 static
@@ -95,12 +104,16 @@ void clean_tables(
 
     for (i = count - 1; i >= 0; i --) {
         EcsTable *table = &buffer[i];
-        ecs_table_deinit(world, table);
+        if (table->type) {
+            ecs_table_deinit(world, table);
+        }
     }
 
     for (i = 0; i < count; i ++) {
         EcsTable *table = &buffer[i];
-        ecs_table_free(world, table);
+        if (table->type) {
+            ecs_table_free(world, table);
+        }
     }
 
     ecs_array_free(stage->tables);
@@ -113,19 +126,9 @@ void ecs_stage_init(
     EcsStage *stage)
 {
     bool is_main_stage = stage == &world->main_stage;
-    bool is_temp_stage = stage == &world->temp_stage;
 
     memset(stage, 0, sizeof(EcsStage));
 
-    stage->entity_index = ecs_map_new(0);
-
-    if (is_temp_stage) {
-        stage->type_index = world->main_stage.type_index;
-    } else {
-        stage->type_index = ecs_map_new(0);
-    }
-
-    stage->table_index = ecs_map_new(0);
     if (is_main_stage) {
         stage->tables = ecs_array_new(&table_arr_params, 8);
     } else {
@@ -133,8 +136,10 @@ void ecs_stage_init(
     }
 
     if (!is_main_stage) {
+        stage->entity_index = ecs_map_new(0);
         stage->data_stage = ecs_map_new(0);
         stage->remove_merge = ecs_map_new(0);
+        stage->delete_stage = ecs_array_new(&handle_arr_params, 0);
     }
 }
 
@@ -143,20 +148,14 @@ void ecs_stage_deinit(
     EcsStage *stage)
 {
     bool is_main_stage = stage == &world->main_stage;
-    bool is_temp_stage = stage == &world->temp_stage;
-
-    ecs_map_free(stage->entity_index);
 
     clean_tables(world, stage);
-    ecs_map_free(stage->table_index);
-
-    if (!is_temp_stage) {
-        clean_families(stage);
-    }
 
     if (!is_main_stage) {
+        ecs_map_free(stage->entity_index);
         ecs_map_free(stage->data_stage);
         ecs_map_free(stage->remove_merge);
+        ecs_array_free(stage->delete_stage);
     }
 }
 
@@ -166,13 +165,9 @@ void ecs_stage_merge(
 {
     assert(stage != &world->main_stage);
     
-    bool is_temp_stage = stage == &world->temp_stage;
-
-    if (!is_temp_stage) {
-        merge_families(world, stage);
-    }
-    
     merge_commits(world, stage);
 
+    merge_deletes(world, stage);
+
     merge_tables(world, stage);
 }
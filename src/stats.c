@@ -20,10 +20,31 @@ void calculate_type_stats(
     uint32_t *allocd,
     uint32_t *used)
 {
-    EcsIter it = ecs_map_iter(world->main_stage.type_index);
-    while (ecs_iter_hasnext(&it)) {
-        EcsArray *type = ecs_iter_next(&it);
-        ecs_array_memory(type, &handle_arr_params, allocd, used);
+    uint32_t i, count = world->type_count;
+    for (i = 1; i <= count; i ++) {
+        EcsTypeRecord *record = ecs_type_get_record(world, i);
+        ecs_array_memory(record->components, &handle_arr_params, allocd, used);
+    }
+
+    ecs_map_memory(world->type_index, allocd, used);
+
+    uint32_t pages = count / ECS_TYPE_PAGE_SIZE + 1;
+    *allocd += pages * ECS_TYPE_PAGE_SIZE * sizeof(EcsTypeRecord);
+    *used += count * sizeof(EcsTypeRecord);
+}
+
+static
+void calculate_row_system_index_stats(
+    EcsWorld *world,
+    uint32_t *allocd,
+    uint32_t *used)
+{
+    uint32_t i, count = world->type_count;
+    for (i = 1; i <= count; i ++) {
+        EcsTypeRecord *record = ecs_type_get_record(world, i);
+        ecs_array_memory(record->add_systems, &handle_arr_params, allocd, used);
+        ecs_array_memory(record->remove_systems, &handle_arr_params, allocd, used);
+        ecs_array_memory(record->set_systems, &handle_arr_params, allocd, used);
     }
 }
 
@@ -44,6 +65,9 @@ void calculate_system_stats(
         ecs_array_memory(sys->jobs, &job_arr_params, allocd, used);
         ecs_array_memory(sys->tables, &sys->table_params, allocd, used);
         ecs_array_memory(sys->refs, &sys->ref_params, allocd, used);
+        ecs_array_memory(sys->ref_cache, &sys->ref_cache_params, allocd, used);
+        ecs_map_memory(sys->table_index, allocd, used);
+        ecs_array_memory(sys->table_slices, &slice_arr_params, allocd, used);
     }
 }
 
@@ -61,6 +85,8 @@ void calculate_table_stats(
         *allocd += ecs_array_count(table->type) * sizeof(uint16_t);
         *used += ecs_array_count(table->type) * sizeof(uint16_t);
     }
+
+    ecs_array_memory(world->dirty_tables, &type_arr_params, allocd, used);
 }
 
 static
@@ -71,20 +97,14 @@ void calculate_stage_stats(
     uint32_t *used)
 {
     bool is_main_stage = stage == &world->main_stage;
-    bool is_temp_stage = stage == &world->temp_stage;
 
-    ecs_map_memory(stage->entity_index, allocd, used);
-
-    if (!is_temp_stage) {
-        ecs_map_memory(stage->type_index, allocd, used);
-    }
-    
     ecs_array_memory(stage->tables, &table_arr_params, allocd, used);
-    ecs_map_memory(stage->table_index, allocd, used);
 
     if (!is_main_stage) {
+        ecs_map_memory(stage->entity_index, allocd, used);
         ecs_map_memory(stage->remove_merge, allocd, used);
         ecs_map_memory(stage->data_stage, allocd, used);
+        ecs_array_memory(stage->delete_stage, &handle_arr_params, allocd, used);
     }
 }
 
@@ -112,9 +132,7 @@ void get_memory_stats(
     ecs_array_memory(world->add_systems, &handle_arr_params, &memory->systems.allocd, &memory->systems.used);
     ecs_array_memory(world->set_systems, &handle_arr_params, &memory->systems.allocd, &memory->systems.used);
     ecs_array_memory(world->remove_systems, &handle_arr_params, &memory->systems.allocd, &memory->systems.used);
-    ecs_map_memory(world->type_sys_add_index, &memory->systems.allocd, &memory->systems.used);
-    ecs_map_memory(world->type_sys_remove_index, &memory->systems.allocd, &memory->systems.used);
-    ecs_map_memory(world->type_sys_set_index, &memory->systems.allocd, &memory->systems.used);
+    calculate_row_system_index_stats(world, &memory->systems.allocd, &memory->systems.used);
 
     ecs_array_memory(world->on_load_systems, &handle_arr_params, &memory->systems.allocd, &memory->systems.used);
     ecs_array_memory(world->pre_frame_systems, &handle_arr_params, &memory->systems.allocd, &memory->systems.used);
@@ -135,7 +153,6 @@ void get_memory_stats(
     calculate_system_stats(world, world->on_demand_systems, &memory->systems.allocd, &memory->systems.used);
 
     ecs_map_memory(world->type_handles, &memory->families.allocd, &memory->families.used);
-    ecs_map_memory(world->prefab_index, &memory->families.allocd, &memory->families.used);
     calculate_type_stats(world, &memory->families.allocd, &memory->families.used);
     calculate_table_stats(world, &memory->tables.allocd, &memory->tables.used);
 
@@ -143,6 +160,7 @@ void get_memory_stats(
     memory->stage.allocd += sizeof(EcsStage);
     memory->stage.used += sizeof(EcsStage);
 
+    ecs_entity_index_memory(world->entity_index, &memory->world.allocd, &memory->world.used);
     calculate_stage_stats(world, &world->main_stage, &memory->world.allocd, &memory->world.used);
     calculate_stage_stats(world, &world->temp_stage, &memory->stage.allocd, &memory->stage.used);
     calculate_stages_stats(world, &memory->stage.allocd, &memory->stage.used);
@@ -296,7 +314,7 @@ void ecs_get_stats(
     EcsWorldStats *stats)
 {
     uint32_t mem_used = 0, mem_allocd = 0;
-    stats->table_count = ecs_array_count(world->main_stage.tables);
+    stats->table_count = 0;
 
     if (!stats->tables) {
         stats->tables = ecs_array_new(&tablestats_arr_params, stats->table_count);
@@ -308,8 +326,13 @@ void ecs_get_stats(
     uint32_t i, count = ecs_array_count(world->main_stage.tables);
     for (i = 0; i < count; i ++) {
         EcsTable *table = &tables[i];
+        if (!table->type) {
+            continue;
+        }
+
         EcsTableStats *tstats = ecs_array_add(
             &stats->tables, &tablestats_arr_params);
+        stats->table_count ++;
 
         uint32_t row_size = ecs_table_row_size(table);
         tstats->row_count = ecs_table_count(table);
@@ -341,7 +364,7 @@ void ecs_get_stats(
     while (ecs_iter_hasnext(&it)) {
         EcsEntity h = ecs_map_next(&it, NULL);
         EcsTypeComponent *data = ecs_get_ptr(world, h, EcsTypeComponent);
-        EcsArray *type = ecs_map_get(world->main_stage.type_index, data->resolved);
+        EcsArray *type = ecs_type_get(world, NULL, data->resolved);
         EcsEntity *buffer = ecs_array_buffer(type);
         uint32_t i, count = ecs_array_count(type);
 
@@ -409,14 +432,14 @@ void ecs_get_stats(
     stats->memory.systems.used += system_memory;
     stats->memory.systems.allocd += system_memory;
 
-    uint32_t type_memory = ecs_map_count(world->main_stage.type_index) *
+    uint32_t type_memory = world->type_count *
       (sizeof(EcsTypeComponent) + sizeof(EcsId));
     stats->memory.components.used -= type_memory;
     stats->memory.components.allocd -= type_memory;
     stats->memory.families.used += type_memory;
     stats->memory.families.allocd += type_memory;
 
-    stats->entity_count = ecs_map_count(world->main_stage.entity_index);
+    stats->entity_count = ecs_entity_index_count(world->entity_index);
     stats->tick_count = world->tick;
 
     if (world->tick) {
@@ -3,66 +3,116 @@
 #include "include/private/flecs.h"
 #include "include/util/time.h"
 
+/** Get creation sequence of a row system, which determines invocation order */
 static
-void match_type(
+uint32_t row_system_order(
     EcsWorld *world,
-    EcsStage *stage,
-    EcsEntity system,
-    EcsRowSystem *system_data,
-    EcsType type)
+    EcsEntity system)
 {
-    /* Test if the components of the system are equal or a subset of the 
-     * components of the type */
-    EcsEntity match = ecs_type_contains(
-        world, stage, type, system_data->base.and_from_entity, true, false);
+    EcsRowSystem *system_data = ecs_get_ptr(world, system, EcsRowSystem);
+    assert(system_data != NULL);
+    return system_data->base.order;
+}
 
-    /* If there is a match, add the system to the type-row_system index */
-    if (match) {
-        EcsMap *index = NULL;
-        EcsSystemKind kind = system_data->base.kind;
+/** Get trigger index for row systems of a kind */
+static
+EcsMap* trigger_index(
+    EcsWorld *world,
+    EcsSystemKind kind)
+{
+    if (kind == EcsOnAdd) {
+        return world->add_triggers;
+    } else if (kind == EcsOnRemove) {
+        return world->remove_triggers;
+    } else if (kind == EcsOnSet) {
+        return world->set_triggers;
+    } else {
+        ecs_abort(ECS_INVALID_PARAMETERS, NULL);
+    }
 
-        if (kind == EcsOnAdd) {
-            index = world->type_sys_add_index;
-        } else if (kind == EcsOnRemove) {
-            index = world->type_sys_remove_index;
-        } else if (kind == EcsOnSet) {
-            index = world->type_sys_set_index;
-        } else {
-            ecs_abort(ECS_INVALID_PARAMETERS, NULL);
-        }
+    return NULL;
+}
 
-        EcsArray *systems = ecs_map_get(index, type);
-        if (!systems) {
-            systems = ecs_array_new(&handle_arr_params, 1);
+/** Add row system to the trigger index with the component that has the fewest
+ * systems. A system is only triggered if all of its components are in the
+ * type, so one component is enough to find the system. */
+static
+void index_trigger(
+    EcsWorld *world,
+    EcsEntity system,
+    EcsRowSystem *system_data)
+{
+    EcsMap *index = trigger_index(world, system_data->base.kind);
+    EcsArray *type = ecs_type_get(
+        world, NULL, system_data->base.and_from_entity);
+    EcsEntity *buffer = ecs_array_buffer(type);
+    uint32_t i, count = ecs_array_count(type);
+
+    EcsEntity component = 0;
+    EcsArray *systems = ecs_map_get(index, 0);
+
+    for (i = 0; i < count; i ++) {
+        EcsArray *candidate = ecs_map_get(index, buffer[i]);
+        if (!component || ecs_array_count(candidate) < ecs_array_count(systems)) {
+            component = buffer[i];
+            systems = candidate;
         }
+    }
 
-        EcsEntity *new_elem = ecs_array_add(&systems, &handle_arr_params);
-        *new_elem = system;
+    EcsEntity *elem = ecs_array_add(&systems, &handle_arr_params);
+    *elem = system;
+    ecs_map_set(index, component, systems);
 
-        /* Always set the system entry, as array may have been realloc'd */
-        ecs_map_set(index, type, systems);
-    }
+    world->trigger_version ++;
 }
 
-/* Match system against existing families to build the type-rowsys index */
+/** Find row systems of kind with components that are all in the type */
 static
-void match_families(
+EcsArray* match_triggers(
     EcsWorld *world,
-    EcsEntity system,
-    EcsRowSystem *system_data)
+    EcsType type_id,
+    EcsSystemKind kind)
 {
-    EcsIter it = ecs_map_iter(world->main_stage.type_index);
-
-    /* Iterating over a map is a bit slow, but this only happens when a new
-     * row system is created, which is very infrequent. */
-    while (ecs_iter_hasnext(&it)) {
-        uint64_t key; /* Only interested in the key, which is the type hash */
-        ecs_map_next(&it, &key);
+    EcsMap *index = trigger_index(world, kind);
+    EcsArray *type = ecs_type_get(world, NULL, type_id);
+    EcsEntity *buffer = ecs_array_buffer(type);
+    uint32_t i, count = ecs_array_count(type);
+    EcsArray *result = NULL;
+
+    /* Systems without components are indexed by 0 */
+    for (i = 0; i <= count; i ++) {
+        EcsArray *systems = ecs_map_get(index, i ? buffer[i - 1] : 0);
+        EcsEntity *sys_buffer = ecs_array_buffer(systems);
+        uint32_t s, sys_count = ecs_array_count(systems);
+
+        for (s = 0; s < sys_count; s ++) {
+            EcsRowSystem *system_data = ecs_get_ptr(
+                world, sys_buffer[s], EcsRowSystem);
+            EcsType and_type = system_data->base.and_from_entity;
+
+            if (!and_type || ecs_type_contains(
+                world, NULL, type_id, and_type, true, false))
+            {
+                ecs_array_add(&result, &handle_arr_params);
+                EcsEntity *result_buffer = ecs_array_buffer(result);
+                int32_t r = ecs_array_count(result) - 1;
+
+                /* Invoke systems in the order in which they were created. The
+                 * handle can't be used for this, as recycled handles can be
+                 * larger than those of systems created later. */
+                while (r && row_system_order(
+                    world, result_buffer[r - 1]) > system_data->base.order)
+                {
+                    result_buffer[r] = result_buffer[r - 1];
+                    r --;
+                }
 
-        EcsType type = key;
-        
-        match_type(world, NULL, system, system_data, type);
+                result_buffer[r] = sys_buffer[s];
+            }
+        }
     }
+
+    return result;
 }
 
 /** Create a new row system. A row system is a system executed on a single row,
@@ -85,6 +135,7 @@ EcsEntity new_row_system(
     EcsEntity result = _ecs_new(world, world->t_row_system);
     EcsId *id_data = ecs_get_ptr(world, result, EcsId);
     *id_data = id;
+    ecs_world_register_name(world, result, id);
 
     EcsRowSystem *system_data = ecs_get_ptr(world, result, EcsRowSystem);
     memset(system_data, 0, sizeof(EcsRowSystem));
@@ -92,6 +143,7 @@ EcsEntity new_row_system(
     system_data->base.signature = sig;
     system_data->base.enabled = true;
     system_data->base.kind = kind;
+    system_data->base.order = ++ world->system_order;
     system_data->components = ecs_array_new(&handle_arr_params, count);
 
     if (ecs_parse_component_expr(
@@ -142,7 +194,7 @@ EcsEntity new_row_system(
     ecs_system_compute_and_families(world, result, &system_data->base);
 
     if (needs_tables) {
-        match_families(world, result, system_data);
+        index_trigger(world, result, system_data);
     }
 
     return result;
@@ -182,6 +234,7 @@ EcsResult ecs_parse_component_action(
     EcsWorld *world,
     EcsSystemExprElemKind elem_kind,
     EcsSystemExprOperKind oper_kind,
+    EcsSystemExprInOutKind inout_kind,
     const char *component_id,
     const char *source_id,
     void *data)
@@ -214,6 +267,7 @@ EcsResult ecs_parse_component_action(
         elem = ecs_array_add(&system_data->columns, &column_arr_params);
         elem->kind = elem_kind;
         elem->oper_kind = oper_kind;
+        elem->inout_kind = inout_kind;
         elem->is.component = component;
 
         if (elem_kind == EcsFromEntity) {
@@ -248,6 +302,7 @@ EcsResult ecs_parse_component_action(
         elem = ecs_array_add(&system_data->columns, &column_arr_params);
         elem->kind = EcsFromId; /* Just pass handle to system */
         elem->oper_kind = EcsOperNot;
+        elem->inout_kind = EcsIn;
         elem->is.component = component;
 
         if (elem_kind == EcsFromSelf) {
@@ -270,7 +325,7 @@ error:
 bool ecs_notify_row_system(
     EcsWorld *world,
     EcsEntity system,
-    EcsArray *type,
+    EcsTable *table,
     EcsTableColumn *table_columns,
     uint32_t offset,
     uint32_t limit)
@@ -293,7 +348,8 @@ bool ecs_notify_row_system(
 
     for (i = 0; i < column_count; i ++) {
         if (buffer[i].kind == EcsFromSelf) {
-            columns[i] = ecs_type_index_of(type, buffer[i].is.component) + 1;
+            columns[i] = ecs_table_column_index(
+                table, buffer[i].is.component) + 1;
         } else {
             EcsEntity entity = 0;
             EcsType component = ecs_type_from_entity(world, buffer[i].is.component);;
@@ -325,6 +381,7 @@ bool ecs_notify_row_system(
         .index_offset = 0,
         .begin = offset,
         .end = offset + limit,
+        .padded_end = offset + limit,
         .count = limit
     };
 
@@ -353,16 +410,35 @@ void ecs_run_task(
     ecs_notify_row_system(world, system, NULL, NULL, 0, 1);
 }
 
-/* Notify row system of a new type */
-void ecs_row_system_notify_of_type(
+/** Row systems are matched with a type the first time the type is used in a
+ * notification, and are matched again after a row system has been added */
+EcsArray* ecs_row_systems_for_type(
     EcsWorld *world,
-    EcsStage *stage,
-    EcsEntity system,
-    EcsType type)
+    EcsType type_id,
+    EcsSystemKind kind,
+    bool *is_temp)
 {
-    EcsRowSystem *system_data = ecs_get_ptr(world, system, EcsRowSystem);
+    EcsTypeRecord *record = ecs_type_get_record(world, type_id);
+    *is_temp = false;
+
+    if (record->trigger_version != world->trigger_version) {
+        /* Worker threads may not write to the type registry */
+        if (world->in_progress && world->threads_running) {
+            *is_temp = true;
+            return match_triggers(world, type_id, kind);
+        }
 
-    match_type(world, stage, system, system_data, type);
+        ecs_array_free(record->add_systems);
+        ecs_array_free(record->remove_systems);
+        ecs_array_free(record->set_systems);
+
+        record->add_systems = match_triggers(world, type_id, EcsOnAdd);
+        record->remove_systems = match_triggers(world, type_id, EcsOnRemove);
+        record->set_systems = match_triggers(world, type_id, EcsOnSet);
+        record->trigger_version = world->trigger_version;
+    }
+
+    return *ecs_type_get_row_systems(world, type_id, kind);
 }
 
 /* -- Public API -- */
@@ -506,6 +582,18 @@ void ecs_set_period(
     }
 }
 
+void ecs_set_skip_unchanged(
+    EcsWorld *world,
+    EcsEntity system,
+    bool enabled)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    if (system_data) {
+        system_data->skip_unchanged = enabled;
+    }
+}
+
 void* _ecs_column(
     EcsRows *rows,
     uint32_t index,
@@ -689,3 +777,18 @@ void *_ecs_field(
         return ECS_OFFSET(buffer, column->size * index);
     }
 }
+
+bool ecs_column_changed(
+    EcsRows *rows,
+    uint32_t index)
+{
+    ecs_assert(index <= rows->column_count, 
+        ECS_COLUMN_INDEX_OUT_OF_RANGE, NULL);
+
+    /* Changes of systems with many columns are not tracked per column */
+    if (index >= 32) {
+        return true;
+    }
+
+    return (rows->changed & (1u << index)) != 0;
+}
@@ -1,8 +1,31 @@
 #include <assert.h>
+#include <string.h>
 #include "include/private/flecs.h"
 
 /** Notify systems that a table has changed its active state */
 static
+void notify_systems(
+    EcsWorld *world,
+    EcsTable *table,
+    bool activate)
+{
+    EcsArray *systems = table->frame_systems;
+    if (systems) {
+        EcsIter it = ecs_array_iter(systems, &handle_arr_params);
+        while (ecs_iter_hasnext(&it)) {
+            EcsEntity system = *(EcsEntity*)ecs_iter_next(&it);
+            ecs_system_activate_table(world, system, table, activate);
+        }
+    }
+
+    table->is_active = activate;
+}
+
+/** Change active state of a table. If activation is deferred, the table is
+ * added to the dirty list, which is processed at the start of the next frame.
+ * Tables that become empty and are filled again before that never notify
+ * their systems. */
+static
 void activate_table(
     EcsWorld *world,
     EcsTable *table,
@@ -11,16 +34,178 @@ void activate_table(
 {
     if (system) {
         ecs_system_activate_table(world, system, table, activate);
+    } else if (world->deferred_activation) {
+        if (!activate) {
+            table->empty_frames = 0;
+        }
+
+        if (!table->is_dirty) {
+            EcsType *elem = ecs_array_add(
+                &world->dirty_tables, &type_arr_params);
+            *elem = table->type_id;
+            table->is_dirty = true;
+        }
     } else {
-        EcsArray *systems = table->frame_systems;
-        if (systems) {
-            EcsIter it = ecs_array_iter(systems, &handle_arr_params);
-            while (ecs_iter_hasnext(&it)) {
-                system = *(EcsEntity*)ecs_iter_next(&it);
-                ecs_system_activate_table(world, system, table, activate);
+        notify_systems(world, table, activate);
+    }
+}
+
+/** Mark all columns as written. Systems that skip unchanged tables will process
+ * the table the next time they run. */
+static
+void mark_changed(
+    EcsWorld *world,
+    EcsTable *table,
+    EcsTableColumn *columns)
+{
+    uint32_t i, column_last = ecs_array_count(table->type) + 1;
+    uint32_t version = world->change_version;
+
+    for (i = 0; i < column_last; i ++) {
+        columns[i].version = version;
+    }
+}
+
+/** Swap two rows in all columns of a table */
+static
+void swap_rows(
+    EcsTable *table,
+    uint32_t row_1,
+    uint32_t row_2)
+{
+    EcsTableColumn *columns = table->columns;
+    uint32_t i, column_last = ecs_array_count(table->type) + 1;
+
+    EcsEntity *entities = ecs_array_buffer(columns[0].data);
+    EcsEntity e = entities[row_1];
+    entities[row_1] = entities[row_2];
+    entities[row_2] = e;
+
+    for (i = 1; i < column_last; i ++) {
+        uint32_t size = columns[i].size;
+        if (size) {
+            char *data = ecs_array_buffer(columns[i].data);
+            char tmp[size];
+            memcpy(tmp, &data[row_1 * size], size);
+            memcpy(&data[row_1 * size], &data[row_2 * size], size);
+            memcpy(&data[row_2 * size], tmp, size);
+        }
+    }
+}
+
+/** Quicksort rows lo..hi (inclusive) on the value in column. Returns whether
+ * any rows were moved. */
+static
+bool sort_rows(
+    EcsTable *table,
+    int32_t column,
+    EcsCompareAction compare,
+    int32_t lo,
+    int32_t hi)
+{
+    EcsEntity *entities = ecs_array_buffer(table->columns[0].data);
+    char *data = ecs_array_buffer(table->columns[column].data);
+    uint32_t size = table->columns[column].size;
+    char pivot[size];
+    bool moved = false;
+
+    while (lo < hi) {
+        int32_t p = lo + (hi - lo) / 2;
+        EcsEntity pivot_entity = entities[p];
+        memcpy(pivot, &data[p * size], size);
+
+        int32_t i = lo - 1, j = hi + 1;
+        while (true) {
+            do {
+                i ++;
+            } while (compare(
+                entities[i], &data[i * size], pivot_entity, pivot) < 0);
+
+            do {
+                j --;
+            } while (compare(
+                entities[j], &data[j * size], pivot_entity, pivot) > 0);
+
+            if (i >= j) {
+                break;
             }
+
+            swap_rows(table, i, j);
+            moved = true;
+        }
+
+        /* Recurse into the smaller partition to bound stack depth */
+        if (j - lo < hi - j) {
+            moved |= sort_rows(table, column, compare, lo, j);
+            lo = j + 1;
+        } else {
+            moved |= sort_rows(table, column, compare, j + 1, hi);
+            hi = j;
+        }
+    }
+
+    return moved;
+}
+
+/** Find destination type of a table edge, compute and store it if unknown */
+static
+EcsType traverse_edge(
+    EcsWorld *world,
+    EcsStage *stage,
+    EcsTable *table,
+    EcsMap **edges,
+    EcsType type,
+    bool add)
+{
+    /* Worker threads may follow edges of the same table concurrently, so the
+     * edge cache is only used when there is a single thread mutating tables */
+    bool use_cache = !world->in_progress || !world->threads_running;
+    uint64_t result;
+
+    if (use_cache && *edges && ecs_map_has(*edges, type, &result)) {
+        return result;
+    }
+
+    EcsArray *arr = ecs_type_get(world, stage, type);
+
+    if (add) {
+        result = ecs_type_merge_arr(world, stage, table->type, arr, NULL);
+    } else {
+        result = ecs_type_merge_arr(world, stage, table->type, NULL, arr);
+    }
+
+    if (use_cache) {
+        if (!*edges) {
+            *edges = ecs_map_new(0);
         }
+
+        ecs_map_set64(*edges, type, result);
     }
+
+    return result;
+}
+
+/** Hash function for column index */
+static
+uint32_t column_hash(
+    EcsEntity component)
+{
+    return (component * 0x9E3779B97F4A7C15ULL) >> 32;
+}
+
+/** Get parameters for a column array. When the world has a SIMD width, column
+ * buffers are aligned and their size is a multiple of the width. */
+static
+EcsArrayParams column_params(
+    EcsWorld *world,
+    uint32_t size)
+{
+    uint32_t width = world->simd_width;
+    return (EcsArrayParams){
+        .element_size = size,
+        .alignment = width ? ECS_COLUMN_ALIGNMENT : 0,
+        .padding = width
+    };
 }
 
 /* -- Private functions -- */
@@ -52,6 +237,54 @@ EcsTableColumn *ecs_table_get_columns(
     return result;
 }
 
+void ecs_table_init_column_index(
+    EcsTable *table)
+{
+    EcsEntity *buf = ecs_array_buffer(table->type);
+    uint32_t i, count = ecs_array_count(table->type);
+    uint32_t slot_count = 2;
+
+    /* Keep the index at most half full, so that probe sequences are short */
+    while (slot_count < count * 2) {
+        slot_count *= 2;
+    }
+
+    table->column_index = malloc(slot_count * sizeof(int16_t));
+    ecs_assert(table->column_index != NULL, ECS_OUT_OF_MEMORY, NULL);
+    table->column_index_mask = slot_count - 1;
+
+    memset(table->column_index, -1, slot_count * sizeof(int16_t));
+
+    for (i = 0; i < count; i ++) {
+        uint32_t slot = column_hash(buf[i]) & table->column_index_mask;
+        while (table->column_index[slot] != -1) {
+            slot = (slot + 1) & table->column_index_mask;
+        }
+
+        table->column_index[slot] = i;
+    }
+}
+
+int16_t ecs_table_column_index(
+    EcsTable *table,
+    EcsEntity component)
+{
+    EcsEntity *buf = ecs_array_buffer(table->type);
+    uint32_t mask = table->column_index_mask;
+    uint32_t slot = column_hash(component) & mask;
+    int16_t index;
+
+    while ((index = table->column_index[slot]) != -1) {
+        if (buf[index] == component) {
+            return index;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return -1;
+}
+
 EcsResult ecs_table_init(
     EcsWorld *world,
     EcsStage *stage,
@@ -62,8 +295,15 @@ EcsResult ecs_table_init(
     bool prefab_set = false;
 
     table->frame_systems = NULL;
+    table->add_edges = NULL;
+    table->remove_edges = NULL;
     table->type = type;
+    table->version = 0;
+    table->empty_frames = 0;
+    table->is_active = false;
+    table->is_dirty = false;
     table->columns = ecs_table_get_columns(world, stage, type);
+    ecs_table_init_column_index(table);
 
     if (stage == &world->main_stage) {
         EcsEntity *buf = ecs_array_buffer(type);
@@ -77,8 +317,8 @@ EcsResult ecs_table_init(
                     ecs_assert(prefab_set == false, ECS_MORE_THAN_ONE_PREFAB, ecs_id(world, buf[i]));
                     prefab_set = true;
 
-                    /* Register type with prefab index for quick lookups */
-                    ecs_map_set(world->prefab_index, table->type_id, buf[i]);
+                    /* Register prefab with type for quick lookups */
+                    ecs_type_get_record(world, table->type_id)->prefab = buf[i];
                 }
             }
         }
@@ -106,8 +346,133 @@ void ecs_table_free(
     }
 
     free(table->columns);
+    free(table->column_index);
 
     ecs_array_free(table->frame_systems);
+
+    if (table->add_edges) {
+        ecs_map_free(table->add_edges);
+    }
+
+    if (table->remove_edges) {
+        ecs_map_free(table->remove_edges);
+    }
+}
+
+EcsType ecs_table_traverse_add(
+    EcsWorld *world,
+    EcsStage *stage,
+    EcsTable *table,
+    EcsType to_add)
+{
+    return traverse_edge(world, stage, table, &table->add_edges, to_add, true);
+}
+
+EcsType ecs_table_traverse_remove(
+    EcsWorld *world,
+    EcsStage *stage,
+    EcsTable *table,
+    EcsType to_remove)
+{
+    return traverse_edge(
+        world, stage, table, &table->remove_edges, to_remove, false);
+}
+
+EcsMovePlan* ecs_table_new_move_plan(
+    EcsWorld *world,
+    EcsTable *src_table,
+    EcsTable *dst_table)
+{
+    uint16_t i_dst = 0, dst_component_count = ecs_array_count(dst_table->type);
+    uint16_t i_src = 0, src_component_count = ecs_array_count(src_table->type);
+    EcsEntity *dst_components = ecs_array_buffer(dst_table->type);
+    EcsEntity *src_components = ecs_array_buffer(src_table->type);
+    uint32_t max_count = dst_component_count < src_component_count
+        ? dst_component_count
+        : src_component_count
+        ;
+
+    EcsMovePlan *result = malloc(
+        sizeof(EcsMovePlan) + max_count * sizeof(EcsMovePlanColumn));
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+    result->count = 0;
+
+    /* Component lists are sorted, so shared components are found by walking
+     * both lists once */
+    while (i_dst < dst_component_count && i_src < src_component_count) {
+        EcsEntity dst_component = dst_components[i_dst];
+        EcsEntity src_component = src_components[i_src];
+
+        if (dst_component == src_component) {
+            uint16_t size = dst_table->columns[i_dst + 1].size;
+            if (size) {
+                result->columns[result->count ++] = (EcsMovePlanColumn){
+                    .src = i_src + 1,
+                    .dst = i_dst + 1,
+                    .size = size
+                };
+            }
+            i_dst ++;
+            i_src ++;
+        } else if (dst_component < src_component) {
+            i_dst ++;
+        } else {
+            i_src ++;
+        }
+    }
+
+    return result;
+}
+
+EcsMovePlan* ecs_table_get_move_plan(
+    EcsWorld *world,
+    EcsTable *src_table,
+    EcsTable *dst_table)
+{
+    /* Worker threads may move rows between the same types concurrently, so the
+     * cache is only used when there is a single thread mutating tables */
+    if (world->in_progress && world->threads_running) {
+        return NULL;
+    }
+
+    EcsTypeRecord *record = ecs_type_get_record(world, src_table->type_id);
+    EcsMovePlan *result = NULL;
+
+    if (!record->move_plans) {
+        record->move_plans = ecs_map_new(0);
+    } else {
+        result = ecs_map_get(record->move_plans, dst_table->type_id);
+    }
+
+    if (!result) {
+        result = ecs_table_new_move_plan(world, src_table, dst_table);
+        ecs_map_set(record->move_plans, dst_table->type_id, result);
+    }
+
+    return result;
+}
+
+void ecs_table_copy_w_plan(
+    EcsMovePlan *plan,
+    EcsTableColumn *dst_columns,
+    uint32_t dst_index,
+    EcsTableColumn *src_columns,
+    uint32_t src_index,
+    uint32_t count)
+{
+    uint32_t i;
+    for (i = 0; i < plan->count; i ++) {
+        EcsMovePlanColumn *column = &plan->columns[i];
+        uint32_t size = column->size;
+        void *dst = ecs_array_buffer(dst_columns[column->dst].data);
+        void *src = ecs_array_buffer(src_columns[column->src].data);
+
+        ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        memcpy(ECS_OFFSET(dst, dst_index * size), 
+            ECS_OFFSET(src, src_index * size), size * count);
+    }
 }
 
 void ecs_table_register_system(
@@ -119,11 +484,50 @@ void ecs_table_register_system(
     EcsEntity *h = ecs_array_add(&table->frame_systems, &handle_arr_params);
     if (h) *h = system;
 
-    if (ecs_array_count(table->columns[0].data)) {
+    /* With deferred activation, a table can be active while empty, or
+     * inactive while not empty. New systems follow the state of the table, so
+     * that the next table update notifies all systems consistently. */
+    bool active = world->deferred_activation
+        ? table->is_active
+        : ecs_array_count(table->columns[0].data) != 0
+        ;
+
+    if (active) {
         activate_table(world, table, system, true);
     }
 }
 
+void ecs_table_activate_dirty(
+    EcsWorld *world)
+{
+    EcsArray *tables = world->main_stage.tables;
+    EcsType *buffer = ecs_array_buffer(world->dirty_tables);
+    uint32_t i, kept = 0, count = ecs_array_count(world->dirty_tables);
+    uint32_t delay = world->deferred_activation ? world->deactivation_delay : 0;
+
+    for (i = 0; i < count; i ++) {
+        EcsTable *table = ecs_array_get(tables, &table_arr_params, buffer[i]);
+        bool active = ecs_table_count(table) != 0;
+
+        /* Keep recently emptied tables active for a number of frames, so that
+         * tables that are emptied and filled frequently don't thrash */
+        if (!active && table->is_active && table->empty_frames < delay) {
+            table->empty_frames ++;
+            buffer[kept ++] = buffer[i];
+            continue;
+        }
+
+        table->is_dirty = false;
+
+        if (active != table->is_active) {
+            notify_systems(world, table, active);
+            world->valid_schedule = false;
+        }
+    }
+
+    ecs_array_set_count(&world->dirty_tables, &type_arr_params, kept);
+}
+
 uint32_t ecs_table_insert(
     EcsWorld *world,
     EcsTable *table,
@@ -131,29 +535,43 @@ uint32_t ecs_table_insert(
     EcsEntity entity)
 {
     uint32_t column_count = ecs_array_count(table->type);
+    EcsArray *entity_column = columns[0].data;
+    EcsArrayParams params = column_params(world, sizeof(EcsEntity));
 
     /* Fist add entity to column with entity ids */
-    EcsEntity *e = ecs_array_add(&columns[0].data, &handle_arr_params);
+    EcsEntity *e = ecs_array_add(&columns[0].data, &params);
     if (!e) {
         return -1;
     }
 
+    bool moved = columns[0].data != entity_column;
+
     *e = entity;
 
-    /* Add elements to each column array */
+    /* Add elements to each column array. Columns can be reallocated
+     * independently from each other, as realloc may grow a buffer in place. */
     uint32_t i;
     for (i = 1; i < column_count + 1; i ++) {
         uint32_t size = columns[i].size;
         if (size) {
-            EcsArrayParams params = {.element_size = size};
+            EcsArray *data = columns[i].data;
+            params.element_size = size;
             if (!ecs_array_add(&columns[i].data, &params)) {
                 return -1;
             }
+            moved |= columns[i].data != data;
         }
     }
 
+    /* Invalidate references to components in the table */
+    if (moved) {
+        table->version ++;
+    }
+
     uint32_t index = ecs_array_count(columns[0].data) - 1;
 
+    mark_changed(world, table, columns);
+
     if (!world->in_progress && !index) {
         activate_table(world, table, 0, true);
     }
@@ -177,6 +595,10 @@ void ecs_table_delete(
     
     ecs_assert(index <= count, ECS_INTERNAL_ERROR, NULL);
 
+    table->version ++;
+
+    mark_changed(world, table, columns);
+
     uint32_t column_last = ecs_array_count(table->type) + 1;
     uint32_t i;
 
@@ -197,7 +619,7 @@ void ecs_table_delete(
         EcsRow row;
         row.type_id = table->type_id;
         row.index = index;
-        ecs_map_set64(world->main_stage.entity_index, to_move, ecs_from_row(row));
+        ecs_entity_index_set(world->entity_index, to_move, row);
 
         /* Decrease size of entity column */
         ecs_array_remove_last(entity_column);
@@ -230,6 +652,129 @@ void ecs_table_delete(
     }
 }
 
+void ecs_table_clear(
+    EcsWorld *world,
+    EcsTable *table)
+{
+    EcsTableColumn *columns = table->columns;
+    uint32_t i, column_last = ecs_array_count(table->type) + 1;
+
+    if (!ecs_array_count(columns[0].data)) {
+        return;
+    }
+
+    table->version ++;
+
+    mark_changed(world, table, columns);
+
+    for (i = 0; i < column_last; i ++) {
+        ecs_array_free(columns[i].data);
+        columns[i].data = NULL;
+    }
+
+    if (!world->in_progress) {
+        activate_table(world, table, 0, false);
+    }
+}
+
+uint32_t ecs_table_move_all(
+    EcsWorld *world,
+    EcsTable *dst_table,
+    EcsTable *src_table)
+{
+    EcsTableColumn *dst_columns = dst_table->columns;
+    EcsTableColumn *src_columns = src_table->columns;
+    uint32_t count = ecs_array_count(src_columns[0].data);
+    uint32_t dst_count = ecs_array_count(dst_columns[0].data);
+
+    if (!count) {
+        return dst_count;
+    }
+
+    dst_table->version ++;
+
+    /* Append entity ids of source table to destination table */
+    EcsArrayParams params = column_params(world, sizeof(EcsEntity));
+    EcsEntity *e = ecs_array_addn(&dst_columns[0].data, &params, count);
+    if (!e) {
+        return -1;
+    }
+
+    memcpy(e, ecs_array_buffer(src_columns[0].data), 
+        count * sizeof(EcsEntity));
+
+    /* Grow columns of destination table. Values of components that are not
+     * in the source table are left uninitialized. */
+    uint32_t i, column_last = ecs_array_count(dst_table->type) + 1;
+    for (i = 1; i < column_last; i ++) {
+        if (dst_columns[i].size) {
+            params.element_size = dst_columns[i].size;
+            if (!ecs_array_addn(&dst_columns[i].data, &params, count)) {
+                break;
+            }
+        }
+    }
+
+    /* If a column could not grow, shrink the columns that did grow back to
+     * their original count, so that all columns have the same number of rows.
+     * Shrinking the count does not reallocate. */
+    if (i != column_last) {
+        uint32_t c;
+        for (c = 0; c < i; c ++) {
+            if (dst_columns[c].size) {
+                params.element_size = dst_columns[c].size;
+                ecs_array_set_count(&dst_columns[c].data, &params, dst_count);
+            }
+        }
+
+        return -1;
+    }
+
+    /* Copy shared columns as a single block */
+    EcsMovePlan *plan = ecs_table_get_move_plan(world, src_table, dst_table);
+    ecs_table_copy_w_plan(plan, dst_columns, dst_count, src_columns, 0, count);
+
+    mark_changed(world, dst_table, dst_columns);
+
+    ecs_table_clear(world, src_table);
+
+    if (!world->in_progress && !dst_count) {
+        activate_table(world, dst_table, 0, true);
+    }
+
+    /* Return index of first moved entity */
+    return dst_count;
+}
+
+void ecs_table_sort(
+    EcsWorld *world,
+    EcsTable *table,
+    int32_t column,
+    EcsCompareAction compare)
+{
+    uint32_t i, count = ecs_array_count(table->columns[0].data);
+    if (count < 2) {
+        return;
+    }
+
+    ecs_assert(table->columns[column].size != 0, ECS_INTERNAL_ERROR, NULL);
+
+    if (!sort_rows(table, column, compare, 0, count - 1)) {
+        return;
+    }
+
+    table->version ++;
+
+    mark_changed(world, table, table->columns);
+
+    /* Update rows of the entities in the entity index */
+    EcsEntity *entities = ecs_array_buffer(table->columns[0].data);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_index_set(world->entity_index, entities[i], 
+            (EcsRow){.type_id = table->type_id, .index = i});
+    }
+}
+
 uint32_t ecs_table_grow(
     EcsWorld *world,
     EcsTable *table,
@@ -239,12 +784,17 @@ uint32_t ecs_table_grow(
 {
     uint32_t column_count = ecs_array_count(table->type);
 
+    EcsArray *entity_column = columns[0].data;
+    EcsArrayParams params = column_params(world, sizeof(EcsEntity));
+
     /* Fist add entity to column with entity ids */
-    EcsEntity *e = ecs_array_addn(&columns[0].data, &handle_arr_params, count);
+    EcsEntity *e = ecs_array_addn(&columns[0].data, &params, count);
     if (!e) {
         return -1;
     }
 
+    bool moved = columns[0].data != entity_column;
+
     uint32_t i;
     for (i = 0; i < count; i ++) {
         e[i] = first_entity + i;
@@ -252,12 +802,21 @@ uint32_t ecs_table_grow(
 
     /* Add elements to each column array */
     for (i = 1; i < column_count + 1; i ++) {
-        EcsArrayParams params = {.element_size = columns[i].size};
+        EcsArray *data = columns[i].data;
+        params.element_size = columns[i].size;
         if (!ecs_array_addn(&columns[i].data, &params, count)) {
             return -1;
         }
+        moved |= columns[i].data != data;
     }
 
+    /* Invalidate references to components in the table */
+    if (moved) {
+        table->version ++;
+    }
+
+    mark_changed(world, table, columns);
+
     uint32_t row_count = ecs_array_count(columns[0].data);
     if (!world->in_progress && row_count == count) {
         activate_table(world, table, 0, true);
@@ -268,19 +827,23 @@ uint32_t ecs_table_grow(
 }
 
 int16_t ecs_table_dim(
+    EcsWorld *world,
     EcsTable *table,
     uint32_t count)
 {
     EcsTableColumn *columns = table->columns;
     uint32_t column_count = ecs_array_count(table->type);
+    EcsArrayParams params = column_params(world, sizeof(EcsEntity));
+
+    table->version ++;
 
-    if (!ecs_array_set_size(&columns[0].data, &handle_arr_params, count)) {
+    if (!ecs_array_set_size(&columns[0].data, &params, count)) {
         return -1;
     }
 
     uint32_t i;
     for (i = 1; i < column_count + 1; i ++) {
-        EcsArrayParams params = {.element_size = columns[i].size};
+        params.element_size = columns[i].size;
         if (!ecs_array_set_size(&columns[i].data, &params, count)) {
             return -1;
         }
@@ -289,6 +852,30 @@ int16_t ecs_table_dim(
     return 0;
 }
 
+void ecs_table_realign(
+    EcsWorld *world,
+    EcsTable *table)
+{
+    EcsTableColumn *columns = table->columns;
+    uint32_t i, column_last = ecs_array_count(table->type) + 1;
+
+    for (i = 0; i < column_last; i ++) {
+        EcsArray *data = columns[i].data;
+        if (!data) {
+            continue;
+        }
+
+        /* Aligned buffers cannot be obtained with realloc, copy the column */
+        EcsArrayParams params = column_params(world, columns[i].size);
+        columns[i].data = ecs_array_new_from_buffer(
+            &params, ecs_array_count(data), ecs_array_buffer(data));
+
+        ecs_array_free(data);
+    }
+
+    table->version ++;
+}
+
 uint64_t ecs_table_count(
     EcsTable *table)
 {
@@ -7,6 +7,14 @@ const EcsArrayParams column_arr_params = {
     .element_size = sizeof(EcsSystemColumn)
 };
 
+const EcsArrayParams query_arr_params = {
+    .element_size = sizeof(EcsQuery*)
+};
+
+const EcsArrayParams slice_arr_params = {
+    .element_size = sizeof(EcsTableSlice)
+};
+
 static
 EcsEntity components_contains(
     EcsWorld *world,
@@ -27,10 +35,9 @@ EcsEntity components_contains(
             return 0;
         }
 
-        uint64_t row_64 = ecs_map_get64(world->main_stage.entity_index, h);
-        assert(row_64 != 0);
+        EcsRow row = ecs_entity_index_get(world->entity_index, h);
+        assert(row.type_id != 0);
 
-        EcsRow row = ecs_to_row(row_64);
         EcsEntity component = ecs_type_contains(
             world, &world->main_stage, row.type_id, type, match_all, true);
         if (component != 0) {
@@ -57,10 +64,9 @@ bool components_contains_component(
         EcsEntity h = *(EcsEntity*)ecs_array_get(
             components, &handle_arr_params, i);
 
-        uint64_t row_64 = ecs_map_get64(world->main_stage.entity_index, h);
-        assert(row_64 != 0);
+        EcsRow row = ecs_entity_index_get(world->entity_index, h);
+        assert(row.type_id != 0);
 
-        EcsRow row = ecs_to_row(row_64);
         bool result = ecs_type_contains_component(
             world, &world->main_stage, row.type_id, component, true);
         if (result) {
@@ -77,7 +83,13 @@ bool components_contains_component(
 #define REFS_INDEX (1)
 #define REFS_COUNT (2)
 #define COMPONENTS_INDEX (3)
-#define COLUMNS_INDEX (4)
+#define CHANGED_INDEX (4)
+#define SORTED_INDEX (5)
+#define GROUP_INDEX (6)
+#define COLUMNS_INDEX (8)
+
+/* Maximum number of columns of which changes can be tracked */
+#define MAX_TRACKED_COLUMNS (31)
 
 /* Get ref array for system table */
 static
@@ -96,6 +108,12 @@ EcsSystemRef* get_ref_data(
         ref_data = ecs_array_add(
             &system_data->refs, &system_data->ref_params);
         table_data[REFS_INDEX] = ecs_array_count(system_data->refs);
+
+        /* Add cache element with the same index, which is filled in when the
+         * system runs */
+        EcsRef *ref_cache = ecs_array_add(
+            &system_data->ref_cache, &system_data->ref_cache_params);
+        memset(ref_cache, 0, system_data->ref_cache_params.element_size);
     } else {
         ref_data = ecs_array_get(
             system_data->refs, &system_data->ref_params, table_data[REFS_INDEX] - 1);
@@ -113,7 +131,7 @@ EcsEntity get_entity_for_component(
     EcsEntity component)
 {
     if (entity) {
-        EcsRow row = ecs_to_row(ecs_map_get64(world->main_stage.entity_index, entity));
+        EcsRow row = ecs_entity_index_get(world->entity_index, entity);
         type_id = row.type_id;
     }
 
@@ -128,9 +146,9 @@ EcsEntity get_entity_for_component(
     }
 
     if (i == count) {
-        EcsEntity prefab = ecs_map_get64(world->prefab_index, type_id);
-        if (prefab) {
-            return get_entity_for_component(world, prefab, 0, component);
+        EcsEntity owner = ecs_type_get_prefab_owner(world, type_id, component);
+        if (owner) {
+            return owner;
         }
     }
 
@@ -141,7 +159,65 @@ EcsEntity get_entity_for_component(
     return entity;
 }
 
-/** Add table to system, compute offsets for system components in table rows */
+/** Get group of table. The 64 bit group is stored in two table_data elements. */
+static
+uint64_t get_group(
+    int32_t *table_data)
+{
+    uint64_t group;
+    memcpy(&group, &table_data[GROUP_INDEX], sizeof(uint64_t));
+    return group;
+}
+
+/** Round end of a row range up to the SIMD width of the world. Only rows past
+ * the last entity are padding, so other ranges keep their end. */
+static
+uint32_t get_padded_end(
+    EcsWorld *world,
+    EcsTable *table,
+    uint32_t end)
+{
+    uint32_t width = world->simd_width;
+    if (width && end == ecs_table_count(table)) {
+        end = ((end + width - 1) / width) * width;
+    }
+
+    return end;
+}
+
+/** Compute and store group of table */
+static
+void set_group(
+    EcsWorld *world,
+    EcsColSystem *system_data,
+    int32_t *table_data)
+{
+    uint64_t group = 0;
+
+    if (system_data->group_by) {
+        EcsType type_id = table_data[TABLE_INDEX];
+        group = system_data->group_by(world, type_id, 
+            ecs_type_get(world, NULL, type_id), system_data->group_by_ctx);
+    }
+
+    memcpy(&table_data[GROUP_INDEX], &group, sizeof(uint64_t));
+}
+
+/** Store position of table in the tables or inactive_tables array. The lowest
+ * bit of the stored value indicates whether the table is active. */
+static
+void set_table_index(
+    EcsColSystem *system_data,
+    EcsType table_type,
+    uint32_t index,
+    bool active)
+{
+    ecs_map_set64(system_data->table_index, table_type, 
+        ((uint64_t)index << 1) | (active != 0));
+}
+
+/** Add table to system, compute offsets for system components in table rows.
+ * Queries pass 0 for the system, and are not registered with the table. */
 static
 void add_table(
     EcsWorld *world,
@@ -156,11 +232,19 @@ void add_table(
     uint32_t ref = 0;
     uint32_t column_count = ecs_array_count(system_data->base.columns);
 
-    /* Initially always add table to inactive group. If the system is registered
-     * with the table and the table is not empty, the table will send an
-     * activate signal to the system. */
-    table_data = ecs_array_add(
-        &system_data->inactive_tables, &system_data->table_params);
+    if (system) {
+        /* Initially always add table to inactive group. If the system is 
+         * registered with the table and the table is not empty, the table will
+         * send an activate signal to the system. */
+        table_data = ecs_array_add(
+            &system_data->inactive_tables, &system_data->table_params);
+
+        set_table_index(system_data, table->type_id, 
+            ecs_array_count(system_data->inactive_tables) - 1, false);
+    } else {
+        table_data = ecs_array_add(
+            &system_data->tables, &system_data->table_params);
+    }
 
     /* Add element to array that contains components for this table. Tables
      * typically share the same component list, unless the system contains OR
@@ -169,16 +253,24 @@ void add_table(
     EcsEntity *component_data = ecs_array_add(
         &system_data->components, &system_data->component_params);
 
-    /* Table index is at element 0 */
-    table_data[TABLE_INDEX] = ecs_array_get_index(
-        world->main_stage.tables, &table_arr_params, table);
+    /* Table index is at element 0. Tables are stored at their type id. */
+    table_data[TABLE_INDEX] = table->type_id;
 
     /* Index in ref array is at element 1 (0 means no refs) */
     table_data[REFS_INDEX] = 0;
 
-    /* Index in components array is at element 2 */
+    /* Index in components array is at element 3 */
     table_data[COMPONENTS_INDEX] = ecs_array_count(system_data->components) - 1;
 
+    /* Columns that changed since the last run, computed when the system runs */
+    table_data[CHANGED_INDEX] = -1;
+
+    /* Change version at which table was sorted (-1 if not sorted yet) */
+    table_data[SORTED_INDEX] = -1;
+
+    /* Group of table is at elements 6 and 7 */
+    set_group(world, system_data, table_data);
+
     /* Walk columns parsed from the system signature */
     EcsIter it = ecs_array_iter(system_data->base.columns, &column_arr_params);
     while (ecs_iter_hasnext(&it)) {
@@ -243,7 +335,7 @@ void add_table(
         if (!entity && column->kind != EcsFromId) {
             if (component) {
                 /* Retrieve offset for component */
-                table_data[i] = ecs_type_index_of(table->type, component);
+                table_data[i] = ecs_table_column_index(table, component);
 
                 /* If column is found, add one to the index, as column zero in
                  * a table is reserved for entity id's */
@@ -317,7 +409,12 @@ void add_table(
         ref_data[ref].entity = 0;
     }
 
-    ecs_table_register_system(world, table, system);
+    if (system) {
+        ecs_table_register_system(world, table, system);
+    } else {
+        system_data->sort_dirty = true;
+        system_data->group_dirty = true;
+    }
 }
 
 /* Match table with system */
@@ -411,26 +508,570 @@ void match_tables(
 
     for (i = 0; i < count; i ++) {
         EcsTable *table = &buffer[i];
+        if (!table->type) {
+            continue;
+        }
+
         if (match_table(world, table, system, system_data)) {
             add_table(world, system, system_data, table);
         }
     }
 }
 
-/* -- Private functions -- */
+/** Get pointers of the references of a matched table. Pointers are taken from
+ * the cache when the referenced entities did not move since they were resolved.
+ * The cache is only updated if update is true. */
+static
+void resolve_refs(
+    EcsWorld *world,
+    EcsColSystem *system_data,
+    int32_t *table_data,
+    bool update,
+    void **ref_ptrs)
+{
+    uint32_t ref_index = table_data[REFS_INDEX] - 1;
+    EcsSystemRef *refs = ecs_array_get(
+        system_data->refs, &system_data->ref_params, ref_index);
+    EcsRef *ref_cache = ecs_array_get(
+        system_data->ref_cache, &system_data->ref_cache_params, ref_index);
+
+    int i, count = table_data[REFS_COUNT];
+
+    for (i = 0; i < count; i ++) {
+        EcsRef *ref = &ref_cache[i];
+        EcsEntity entity = refs[i].entity;
+        EcsType component = refs[i].component;
+
+        if (ref->entity != entity || ref->component != component) {
+            if (!update) {
+                ref_ptrs[i] = _ecs_get_ptr(world, entity, component);
+                continue;
+            }
+
+            *ref = (EcsRef){.entity = entity, .component = component};
+        }
+
+        ref_ptrs[i] = ecs_get_ref_ptr(world, ref, update);
+    }
+}
+
+/** Test if the component of a referenced entity changed since a version */
+static
+bool ref_changed(
+    EcsWorld *world,
+    EcsEntity entity,
+    EcsEntity component,
+    uint32_t version)
+{
+    EcsRow row = ecs_entity_index_get(world->entity_index, entity);
+    if (!row.type_id) {
+        return true;
+    }
+
+    EcsTable *table = ecs_world_get_table(
+        world, &world->main_stage, row.type_id);
+    int16_t column_index = ecs_table_column_index(table, component);
+    if (column_index == -1) {
+        return true;
+    }
+
+    return table->columns[column_index + 1].version > version;
+}
+
+/** Compute bitsets of the columns a system reads and writes. The entity column
+ * counts as input, so that new entities are always processed. */
+static
+void compute_inout_columns(
+    EcsColSystem *system_data)
+{
+    EcsSystemColumn *buffer = ecs_array_buffer(system_data->base.columns);
+    uint32_t i, count = ecs_array_count(system_data->base.columns);
+
+    system_data->in_columns = 1;
+    system_data->out_columns = 0;
+
+    if (count > MAX_TRACKED_COLUMNS) {
+        count = MAX_TRACKED_COLUMNS;
+    }
+
+    for (i = 0; i < count; i ++) {
+        EcsSystemColumn *column = &buffer[i];
+        if (column->kind == EcsFromId) {
+            continue;
+        }
+
+        if (column->inout_kind != EcsOut) {
+            system_data->in_columns |= 1u << (i + 1);
+        }
+
+        if (column->inout_kind != EcsIn) {
+            system_data->out_columns |= 1u << (i + 1);
+        }
+    }
+}
+
+/** Compute bitset of columns that changed since the system last ran. Bit 0
+ * is set when entities were added to or removed from the table. */
+static
+uint32_t changed_columns(
+    EcsWorld *world,
+    EcsColSystem *system_data,
+    EcsTable *table,
+    int32_t *table_data)
+{
+    EcsTableColumn *columns = table->columns;
+    uint32_t since = system_data->changed_since;
+    uint32_t i, count = ecs_array_count(system_data->base.columns);
+    uint32_t result = columns[0].version > since;
+    EcsSystemRef *refs = NULL;
+    EcsEntity *components = NULL;
+
+    /* Not all columns fit in the bitset, so assume everything changed */
+    if (count > MAX_TRACKED_COLUMNS) {
+        return ~(uint32_t)0;
+    }
+
+    for (i = 0; i < count; i ++) {
+        int32_t column = table_data[COLUMNS_INDEX + i];
+        bool changed = false;
+
+        if (column > 0) {
+            changed = columns[column].version > since;
+        } else if (column < 0) {
+            if (!refs) {
+                refs = ecs_array_get(system_data->refs, 
+                    &system_data->ref_params, table_data[REFS_INDEX] - 1);
+                components = ecs_array_get(system_data->components, 
+                    &system_data->component_params, 
+                    table_data[COMPONENTS_INDEX]);
+            }
+
+            changed = ref_changed(
+                world, refs[-column - 1].entity, components[i], since);
+        }
+
+        result |= (uint32_t)changed << (i + 1);
+    }
+
+    return result;
+}
+
+/** Pointer to the value of a row that is passed to a compare function */
+static
+void* sort_ptr(
+    char *data,
+    uint32_t size,
+    uint32_t row)
+{
+    if (!data) {
+        return NULL;
+    }
+
+    return &data[size * row];
+}
+
+/** Merge the rows of sorted tables into slices. Each slice is a range of rows
+ * in a single table, so that the system can be invoked with a table column. */
+static
+void build_slices(
+    EcsWorld *world,
+    EcsColSystem *system_data)
+{
+    EcsArray *tables = system_data->tables;
+    uint32_t t, table_count = ecs_array_count(tables);
+    uint32_t column_count = ecs_array_count(system_data->base.columns);
+    uint32_t sort_column = system_data->sort_column;
+    EcsCompareAction compare = system_data->compare;
+    EcsTable *world_tables = ecs_array_buffer(world->main_stage.tables);
+
+    if (system_data->table_slices) {
+        ecs_array_clear(system_data->table_slices);
+    }
+
+    if (!table_count) {
+        return;
+    }
+
+    EcsEntity *entities[table_count];
+    char *data[table_count];
+    uint32_t size[table_count], row[table_count], count[table_count];
+    uint64_t group[table_count];
+    void *ref_ptrs[column_count];
+
+    for (t = 0; t < table_count; t ++) {
+        int32_t *table_data = ecs_array_get(
+            tables, &system_data->table_params, t);
+        EcsTable *table = &world_tables[table_data[TABLE_INDEX]];
+        int32_t column = table_data[COLUMNS_INDEX + sort_column - 1];
+
+        entities[t] = ecs_array_buffer(table->columns[0].data);
+        count[t] = ecs_table_count(table);
+        group[t] = get_group(table_data);
+        row[t] = 0;
+
+        if (column > 0) {
+            data[t] = ecs_array_buffer(table->columns[column].data);
+            size[t] = table->columns[column].size;
+
+        /* Shared components have the same pointer for all rows */
+        } else if (column < 0) {
+            resolve_refs(world, system_data, table_data, true, ref_ptrs);
+            data[t] = ref_ptrs[-column - 1];
+            size[t] = 0;
+        } else {
+            data[t] = NULL;
+            size[t] = 0;
+        }
+    }
+
+    EcsTableSlice *slice = NULL;
+
+    while (true) {
+        int32_t min = -1;
+
+        /* Find the table with the lowest next row. Rows of grouped systems are
+         * ordered by group first. */
+        for (t = 0; t < table_count; t ++) {
+            if (row[t] == count[t]) {
+                continue;
+            }
+
+            if (min != -1 && group[t] != group[min]) {
+                if (group[t] < group[min]) {
+                    min = t;
+                }
+                continue;
+            }
+
+            if (min == -1 || compare(
+                entities[t][row[t]], sort_ptr(data[t], size[t], row[t]),
+                entities[min][row[min]], 
+                sort_ptr(data[min], size[min], row[min])) < 0)
+            {
+                min = t;
+            }
+        }
+
+        if (min == -1) {
+            break;
+        }
+
+        if (slice && slice->table == (uint32_t)min && 
+            slice->begin + slice->count == row[min]) 
+        {
+            slice->count ++;
+        } else {
+            slice = ecs_array_add(
+                &system_data->table_slices, &slice_arr_params);
+            slice->table = min;
+            slice->begin = row[min];
+            slice->count = 1;
+        }
+
+        row[min] ++;
+    }
+}
+
+/** Order active tables by group. Tables are typically activated one at a time,
+ * so the array is mostly ordered, which is why insertion sort is used. */
+static
+void group_tables(
+    EcsWorld *world,
+    EcsColSystem *system_data)
+{
+    if (!system_data->group_by || !system_data->group_dirty) {
+        return;
+    }
+
+    EcsArray *tables = system_data->tables;
+    uint32_t size = system_data->table_params.element_size;
+    char *buffer = ecs_array_buffer(tables);
+    int32_t i, j, count = ecs_array_count(tables);
+    char tmp[size];
+    bool moved = false;
+
+    for (i = 1; i < count; i ++) {
+        uint64_t group = get_group((int32_t*)&buffer[i * size]);
+
+        for (j = i; j > 0; j --) {
+            if (get_group((int32_t*)&buffer[(j - 1) * size]) <= group) {
+                break;
+            }
+        }
+
+        if (j != i) {
+            memcpy(tmp, &buffer[i * size], size);
+            memmove(&buffer[(j + 1) * size], &buffer[j * size], 
+                (i - j) * size);
+            memcpy(&buffer[j * size], tmp, size);
+            moved = true;
+        }
+    }
+
+    /* Job offsets of the system are relative to the order of its tables */
+    if (moved && system_data->entity) {
+        world->valid_schedule = false;
+    }
+
+    /* Queries have no table index, as their tables are never (de)activated */
+    if (system_data->entity) {
+        for (i = 0; i < count; i ++) {
+            int32_t *table_data = (int32_t*)&buffer[i * size];
+            set_table_index(system_data, table_data[TABLE_INDEX], i, true);
+        }
+    }
+
+    system_data->group_dirty = false;
+    system_data->sort_dirty = true;
+}
+
+/** Sort tables in which entities were added or removed, or in which the sorted
+ * column changed since they were last sorted. Slices are only computed again
+ * if a table was sorted, or if the set of active tables changed. */
+static
+void sort_tables(
+    EcsWorld *world,
+    EcsColSystem *system_data)
+{
+    EcsArray *tables = system_data->tables;
+    uint32_t i, count = ecs_array_count(tables);
+    uint32_t sort_column = system_data->sort_column;
+    EcsTable *world_tables = ecs_array_buffer(world->main_stage.tables);
+    bool rebuild = system_data->sort_dirty;
+
+    for (i = 0; i < count; i ++) {
+        int32_t *table_data = ecs_array_get(
+            tables, &system_data->table_params, i);
+        EcsTable *table = &world_tables[table_data[TABLE_INDEX]];
+        int32_t column = table_data[COLUMNS_INDEX + sort_column - 1];
+        uint32_t sorted = table_data[SORTED_INDEX];
+
+        bool changed = table_data[SORTED_INDEX] == -1 || 
+            table->columns[0].version > sorted;
+
+        if (!changed) {
+            if (column > 0) {
+                changed = table->columns[column].version > sorted;
+            } else if (column < 0) {
+                EcsSystemRef *refs = ecs_array_get(system_data->refs, 
+                    &system_data->ref_params, table_data[REFS_INDEX] - 1);
+                EcsEntity *components = ecs_array_get(
+                    system_data->components, &system_data->component_params, 
+                    table_data[COMPONENTS_INDEX]);
+
+                changed = ref_changed(world, refs[-column - 1].entity, 
+                    components[sort_column - 1], sorted);
+            }
+        }
+
+        if (!changed) {
+            continue;
+        }
+
+        if (column > 0) {
+            ecs_table_sort(world, table, column, system_data->compare);
+        }
+
+        table_data[SORTED_INDEX] = world->change_version;
+        rebuild = true;
+    }
+
+    if (rebuild) {
+        build_slices(world, system_data);
+        system_data->sort_dirty = false;
+
+        /* Make sure that writes after sorting have a newer version */
+        world->change_version ++;
+    }
+}
+
+/** Set group function of grouped system or query */
+static
+void set_group_by(
+    EcsWorld *world,
+    EcsColSystem *system_data,
+    EcsGroupByAction group_by,
+    void *ctx)
+{
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    system_data->group_by = group_by;
+    system_data->group_by_ctx = ctx;
+    system_data->group_dirty = true;
+    system_data->sort_dirty = true;
+
+    EcsArray *tables = system_data->tables;
+    uint32_t i, count = ecs_array_count(tables);
+
+    for (i = 0; i < count; i ++) {
+        set_group(world, system_data, 
+            ecs_array_get(tables, &system_data->table_params, i));
+    }
+
+    tables = system_data->inactive_tables;
+    count = ecs_array_count(tables);
+
+    for (i = 0; i < count; i ++) {
+        set_group(world, system_data, 
+            ecs_array_get(tables, &system_data->table_params, i));
+    }
+}
+
+/** Set column and compare function of sorted system or query */
+static
+void set_order_by(
+    EcsWorld *world,
+    EcsColSystem *system_data,
+    EcsType component,
+    EcsCompareAction compare)
+{
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    system_data->compare = compare;
+    system_data->sort_column = 0;
+    system_data->sort_dirty = true;
+
+    if (!compare) {
+        return;
+    }
+
+    EcsEntity entity = ecs_entity_from_type(world, component);
+    EcsSystemColumn *buffer = ecs_array_buffer(system_data->base.columns);
+    uint32_t i, count = ecs_array_count(system_data->base.columns);
+
+    for (i = 0; i < count; i ++) {
+        EcsSystemColumn *column = &buffer[i];
+        if (column->kind != EcsFromId && column->oper_kind != EcsOperOr &&
+            column->oper_kind != EcsOperNot && column->is.component == entity)
+        {
+            system_data->sort_column = i + 1;
+            break;
+        }
+    }
+
+    ecs_assert(system_data->sort_column != 0, ECS_INVALID_PARAMETERS, 
+        "component to order by is not a column of the system");
+
+    /* Sort all tables when the system runs */
+    EcsArray *tables = system_data->tables;
+    count = ecs_array_count(tables);
+
+    for (i = 0; i < count; i ++) {
+        int32_t *table_data = ecs_array_get(
+            tables, &system_data->table_params, i);
+        table_data[SORTED_INDEX] = -1;
+    }
+
+    tables = system_data->inactive_tables;
+    count = ecs_array_count(tables);
+
+    for (i = 0; i < count; i ++) {
+        int32_t *table_data = ecs_array_get(
+            tables, &system_data->table_params, i);
+        table_data[SORTED_INDEX] = -1;
+    }
+}
+
+/** Match new table against systems that are indexed by component */
+static
+void notify_indexed_systems(
+    EcsWorld *world,
+    EcsTable *table,
+    EcsEntity component)
+{
+    EcsArray *systems = ecs_map_get(world->component_systems, component);
+    uint32_t i, count = ecs_array_count(systems);
+
+    for (i = 0; i < count; i ++) {
+        /* Adding a table to a system can add systems to the index, so don't
+         * hold on to the buffer */
+        EcsEntity system = *(EcsEntity*)ecs_array_get(
+            systems, &handle_arr_params, i);
+        EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+        assert(system_data != NULL);
+
+        /* A system can be found through multiple components of the table */
+        if (system_data->last_table == table->type_id) {
+            continue;
+        }
+
+        system_data->last_table = table->type_id;
+
+        if (match_table(world, table, system, system_data)) {
+            add_table(world, system, system_data, table);
+        }
+    }
+}
 
-/** Match new table against system (table is created after system) */
-void ecs_col_system_notify_of_table(
+/** Add system to the index with the required component that has the fewest
+ * systems. A table can only match the system if it has (or inherits) every
+ * required component, so one component is enough to find the system. */
+static
+void index_system(
     EcsWorld *world,
     EcsEntity system,
+    EcsColSystem *system_data)
+{
+    EcsArray *type = ecs_type_get(
+        world, NULL, system_data->base.and_from_entity);
+    EcsEntity *buffer = ecs_array_buffer(type);
+    uint32_t i, count = ecs_array_count(type);
+
+    EcsEntity component = 0;
+    EcsArray *systems = ecs_map_get(world->component_systems, 0);
+
+    for (i = 0; i < count; i ++) {
+        EcsArray *candidate = ecs_map_get(world->component_systems, buffer[i]);
+        if (!component || ecs_array_count(candidate) < ecs_array_count(systems)) {
+            component = buffer[i];
+            systems = candidate;
+        }
+    }
+
+    EcsEntity *elem = ecs_array_add(&systems, &handle_arr_params);
+    *elem = system;
+    ecs_map_set(world->component_systems, component, systems);
+}
+
+/* -- Private functions -- */
+
+/** Match new table against the systems indexed by one of its components, or by
+ * one of the components it inherits from its prefabs. Systems without required
+ * components are indexed by 0, and are evaluated for every table. Queries are
+ * not indexed, as applications typically have few of them. */
+void ecs_notify_col_systems_of_table(
+    EcsWorld *world,
     EcsTable *table)
 {
-    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
-    assert(system_data != NULL);
+    EcsType type_id = table->type_id;
+    EcsEntity prefab = 0;
+
+    EcsQuery **queries = ecs_array_buffer(world->queries);
+    uint32_t q, query_count = ecs_array_count(world->queries);
 
-    if (match_table(world, table, system, system_data)) {
-        add_table(world, system, system_data, table);
+    for (q = 0; q < query_count; q ++) {
+        EcsColSystem *system_data = &queries[q]->system_data;
+        if (match_table(world, table, 0, system_data)) {
+            add_table(world, 0, system_data, table);
+        }
     }
+
+    notify_indexed_systems(world, table, 0);
+
+    do {
+        EcsArray *type = ecs_type_get(world, NULL, type_id);
+        EcsEntity *buffer = ecs_array_buffer(type);
+        uint32_t i, count = ecs_array_count(type);
+
+        for (i = 0; i < count; i ++) {
+            notify_indexed_systems(world, table, buffer[i]);
+        }
+
+        /* Walk the prefab chain, as systems can match inherited components */
+        if ((prefab = ecs_type_get_prefab(world, type_id))) {
+            type_id = ecs_entity_index_get(world->entity_index, prefab).type_id;
+        }
+    } while (prefab && type_id);
 }
 
 /** Table activation happens when a table was or becomes empty. Deactivated
@@ -445,8 +1086,13 @@ void ecs_system_activate_table(
     EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
     EcsSystemKind kind = system_data->base.kind;
 
-    uint32_t table_index = ecs_array_get_index(
-        world->main_stage.tables, &table_arr_params, table);
+    uint64_t table_index;
+    bool found = ecs_map_has(
+        system_data->table_index, table->type_id, &table_index);
+    ecs_assert(found, ECS_INTERNAL_ERROR, "cannot find table to (de)activate");
+    ecs_assert((table_index & 1) != (uint64_t)active, ECS_INTERNAL_ERROR, 
+        "table is already (de)activated");
+    (void)found;
 
     if (active) {
         src_array = system_data->inactive_tables;
@@ -456,21 +1102,23 @@ void ecs_system_activate_table(
         dst_array = system_data->inactive_tables;
     }
 
-    uint32_t count = ecs_array_count(src_array);
-    int i;
-    for (i = 0; i < count; i ++) {
-        uint32_t *index = ecs_array_get(
-            src_array, &system_data->table_params, i);
-        if (*index == table_index) {
-            break;
-        }
-    }
-
-    ecs_assert(i != count, ECS_INTERNAL_ERROR, "cannot find table to (de)activate");
+    system_data->sort_dirty = true;
+    system_data->group_dirty = true;
 
+    uint32_t i = table_index >> 1;
     uint32_t src_count = ecs_array_move_index(
         &dst_array, src_array, &system_data->table_params, i);
 
+    set_table_index(system_data, table->type_id, 
+        ecs_array_count(dst_array) - 1, active);
+
+    /* The last table in the source array was moved to the removed slot */
+    if (i < src_count) {
+        int32_t *moved = ecs_array_get(
+            src_array, &system_data->table_params, i);
+        set_table_index(system_data, moved[TABLE_INDEX], i, !active);
+    }
+
     if (active) {
         uint32_t dst_count = ecs_array_count(dst_array);
         if (kind != EcsManual) {
@@ -491,11 +1139,106 @@ void ecs_system_activate_table(
     }
 }
 
-/* -- Private API -- */
+/** Group and sort tables of a system. Worker threads cannot move tables or rows,
+ * so this is done before jobs are started. */
+void ecs_col_system_sort_tables(
+    EcsWorld *world,
+    EcsEntity system)
+{
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    assert(system_data != NULL);
 
-EcsEntity ecs_new_col_system(
+    group_tables(world, system_data);
+
+    if (system_data->compare) {
+        sort_tables(world, system_data);
+    }
+}
+
+/** Resolve references of all active tables. Worker threads cannot update the
+ * reference cache, so this is done before jobs are started. */
+void ecs_col_system_resolve_refs(
     EcsWorld *world,
-    const char *id,
+    EcsEntity system)
+{
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    assert(system_data != NULL);
+
+    if (!system_data->refs) {
+        return;
+    }
+
+    uint32_t column_count = ecs_array_count(system_data->base.columns);
+    void *ref_ptrs[column_count];
+
+    EcsArray *tables = system_data->tables;
+    uint32_t i, count = ecs_array_count(tables);
+
+    for (i = 0; i < count; i ++) {
+        int32_t *table_data = ecs_array_get(
+            tables, &system_data->table_params, i);
+        if (table_data[REFS_INDEX]) {
+            resolve_refs(world, system_data, table_data, true, ref_ptrs);
+        }
+    }
+}
+
+/** Compute which columns of active tables changed since the system last ran,
+ * and mark the columns the system writes as changed. Worker threads only read
+ * the result, so this is done by the main thread before the system runs. */
+void ecs_col_system_track_changes(
+    EcsWorld *world,
+    EcsEntity system)
+{
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    assert(system_data != NULL);
+
+    system_data->changed_since = system_data->last_run;
+    system_data->last_run = world->change_version;
+    uint32_t version = ++ world->change_version;
+
+    uint32_t in_columns = system_data->in_columns;
+    uint32_t out_columns = system_data->out_columns;
+    bool skip_unchanged = system_data->skip_unchanged;
+
+    EcsArray *tables = system_data->tables;
+    uint32_t i, count = ecs_array_count(tables);
+    uint32_t column_count = ecs_array_count(system_data->base.columns);
+    EcsTable *world_tables = ecs_array_buffer(world->main_stage.tables);
+
+    if (column_count > MAX_TRACKED_COLUMNS) {
+        column_count = MAX_TRACKED_COLUMNS;
+    }
+
+    for (i = 0; i < count; i ++) {
+        int32_t *table_data = ecs_array_get(
+            tables, &system_data->table_params, i);
+        EcsTable *table = &world_tables[table_data[TABLE_INDEX]];
+
+        uint32_t changed = changed_columns(
+            world, system_data, table, table_data);
+        table_data[CHANGED_INDEX] = changed;
+
+        if (!out_columns || (skip_unchanged && !(changed & in_columns))) {
+            continue;
+        }
+
+        uint32_t c;
+        for (c = 0; c < column_count; c ++) {
+            int32_t column = table_data[COLUMNS_INDEX + c];
+            if (column > 0 && (out_columns & (1u << (c + 1)))) {
+                table->columns[column].version = version;
+            }
+        }
+    }
+}
+
+/** Initialize system data and parse the signature. Tables are not matched. */
+static
+void init_system_data(
+    EcsWorld *world,
+    EcsEntity system,
+    EcsColSystem *system_data,
     EcsSystemKind kind,
     const char *sig,
     EcsSystemAction action)
@@ -505,13 +1248,6 @@ EcsEntity ecs_new_col_system(
         assert(0);
     }
 
-    EcsEntity result = _ecs_new(
-        world, world->t_col_system);
-
-    EcsId *id_data = ecs_get_ptr(world, result, EcsId);
-    *id_data = id;
-
-    EcsColSystem *system_data = ecs_get_ptr(world, result, EcsColSystem);
     memset(system_data, 0, sizeof(EcsColSystem));
     system_data->base.action = action;
     system_data->base.enabled = true;
@@ -519,12 +1255,14 @@ EcsEntity ecs_new_col_system(
     system_data->base.time_spent = 0;
     system_data->base.columns = ecs_array_new(&column_arr_params, count);
     system_data->base.kind = kind;
+    system_data->base.order = ++ world->system_order;
 
     system_data->table_params.element_size = sizeof(int32_t) * (count + COLUMNS_INDEX);
     system_data->ref_params.element_size = sizeof(EcsSystemRef) * count;
+    system_data->ref_cache_params.element_size = sizeof(EcsRef) * count;
     system_data->component_params.element_size = sizeof(EcsEntity) * count;
     system_data->period = 0;
-    system_data->entity = result;
+    system_data->entity = system;
 
     system_data->components = ecs_array_new(
         &system_data->component_params, ECS_SYSTEM_INITIAL_TABLE_COUNT);
@@ -532,6 +1270,7 @@ EcsEntity ecs_new_col_system(
         &system_data->table_params, ECS_SYSTEM_INITIAL_TABLE_COUNT);
     system_data->inactive_tables = ecs_array_new(
         &system_data->table_params, ECS_SYSTEM_INITIAL_TABLE_COUNT);
+    system_data->table_index = ecs_map_new(ECS_SYSTEM_INITIAL_TABLE_COUNT);
 
     if (ecs_parse_component_expr(
         world, sig, ecs_parse_component_action, system_data) != EcsOk)
@@ -539,37 +1278,54 @@ EcsEntity ecs_new_col_system(
         assert(0);
     }
 
-    ecs_system_compute_and_families(world, result, &system_data->base);
+    ecs_system_compute_and_families(world, system, &system_data->base);
 
-    match_tables(world, result, system_data);
+    compute_inout_columns(system_data);
+}
 
-    EcsEntity *elem = NULL;
+/* -- Private API -- */
 
-    if (kind == EcsManual) {
-        elem = ecs_array_add(&world->on_demand_systems, &handle_arr_params);
-    } else if (!ecs_array_count(system_data->tables)) {
-        elem = ecs_array_add(&world->inactive_systems, &handle_arr_params);
-    } else {
-        if (kind == EcsOnFrame) {
-            elem = ecs_array_add(&world->on_frame_systems, &handle_arr_params);
-        } else if (kind == EcsPreFrame) {
-            elem = ecs_array_add(&world->pre_frame_systems, &handle_arr_params);
-        } else if (kind == EcsPostFrame) {
-            elem = ecs_array_add(&world->post_frame_systems, &handle_arr_params);
-        } else if (kind == EcsOnLoad) {
-            elem = ecs_array_add(&world->on_load_systems, &handle_arr_params);
-        } else if (kind == EcsOnStore) {
-            elem = ecs_array_add(&world->on_store_systems, &handle_arr_params);
-        } else {
-            ecs_abort(ECS_INVALID_PARAMETERS, NULL);
-        }
-    }
+EcsEntity ecs_new_col_system(
+    EcsWorld *world,
+    const char *id,
+    EcsSystemKind kind,
+    const char *sig,
+    EcsSystemAction action)
+{
+    EcsEntity result = _ecs_new(
+        world, world->t_col_system);
 
-    *elem = result;
+    EcsId *id_data = ecs_get_ptr(world, result, EcsId);
+    *id_data = id;
+    ecs_world_register_name(world, result, id);
+
+    EcsColSystem *system_data = ecs_get_ptr(world, result, EcsColSystem);
+    init_system_data(world, result, system_data, kind, sig, action);
+
+    match_tables(world, result, system_data);
+
+    index_system(world, result, system_data);
+
+    ecs_world_add_system(
+        world, result, kind, ecs_array_count(system_data->tables) != 0);
 
     return result;
 }
 
+void ecs_col_system_free(
+    EcsColSystem *system_data)
+{
+    ecs_array_free(system_data->base.columns);
+    ecs_array_free(system_data->components);
+    ecs_array_free(system_data->inactive_tables);
+    ecs_array_free(system_data->jobs);
+    ecs_array_free(system_data->tables);
+    ecs_array_free(system_data->refs);
+    ecs_array_free(system_data->ref_cache);
+    ecs_map_free(system_data->table_index);
+    ecs_array_free(system_data->table_slices);
+}
+
 /* -- Public API -- */
 
 static
@@ -649,6 +1405,27 @@ EcsEntity _ecs_run_w_filter(
     bool limit_set = limit != 0;
     void *ref_ptrs[column_count]; /* Use worst-case size for references */
 
+    /* Worker threads only read the reference cache, it is updated by the main
+     * thread before jobs start. Threads may not have signalled that they are
+     * running yet, so test if the world has threads instead. */
+    bool update_refs = !real_world->in_progress || 
+        !ecs_array_count(real_world->worker_threads);
+
+    /* Change detection state is updated by the same thread as references.
+     * Tables are sorted first, as sorting changes the table columns. */
+    if (update_refs) {
+        group_tables(real_world, system_data);
+
+        if (system_data->compare) {
+            sort_tables(real_world, system_data);
+        }
+
+        ecs_col_system_track_changes(real_world, system);
+    }
+
+    uint32_t in_columns = system_data->in_columns;
+    bool skip_unchanged = system_data->skip_unchanged;
+
     EcsRows info = {
         .world = world,
         .system = system,
@@ -659,17 +1436,45 @@ EcsEntity _ecs_run_w_filter(
         .ref_ptrs = ref_ptrs
     };
 
-    int32_t *table = table_first;
-    for (; table < table_last; table = ECS_OFFSET(table, tables_size)) {
+    /* Sorted systems iterate slices of tables instead of entire tables */
+    EcsTableSlice *slices = NULL;
+    uint32_t chunk, chunk_count = ecs_array_count(tables);
+
+    if (system_data->compare) {
+        slices = ecs_array_buffer(system_data->table_slices);
+        chunk_count = ecs_array_count(system_data->table_slices);
+    }
+
+    for (chunk = 0; chunk < chunk_count; chunk ++) {
+        int32_t *table = ECS_OFFSET(table_first, 
+            tables_size * (slices ? slices[chunk].table : chunk));
         int32_t table_index = table[TABLE_INDEX];
 
         /* A system may introduce a new table if in the main thread. Make sure
          * world_tables points to the valid memory */
-        EcsTable *world_tables = ecs_array_buffer(world->main_stage.tables);
+        EcsTable *world_tables = ecs_array_buffer(real_world->main_stage.tables);
         EcsTable *w_table = &world_tables[table_index];
         EcsTableColumn *table_columns = w_table->columns;
         uint32_t first = 0, count = ecs_table_count(w_table);
 
+        /* The main thread may have removed rows since slices were computed */
+        if (slices) {
+            first = slices[chunk].begin;
+            if (first >= count) {
+                continue;
+            }
+
+            count -= first;
+            if (slices[chunk].count < count) {
+                count = slices[chunk].count;
+            }
+        }
+
+        /* With deferred activation, active tables can be empty */
+        if (!count) {
+            continue;
+        }
+
         if (filter) {
             if (!ecs_type_contains(
                 real_world, stage, w_table->type_id, filter, true, true))
@@ -706,19 +1511,18 @@ EcsEntity _ecs_run_w_filter(
             continue;
         }
 
+        uint32_t changed = table[CHANGED_INDEX];
+        if (skip_unchanged && !(changed & in_columns)) {
+            continue;
+        }
+
         uint32_t ref_index = table[REFS_INDEX];
 
         if (ref_index) {
             info.references = ecs_array_get(
                 system_data->refs, &system_data->ref_params, ref_index - 1);
 
-            /* Resolve references */
-            int i, count = table[REFS_COUNT];
-
-            for (i = 0; i < count; i ++) {
-                info.ref_ptrs[i] = _ecs_get_ptr(world, 
-                    info.references[i].entity, info.references[i].component);
-            }
+            resolve_refs(world, system_data, table, update_refs, ref_ptrs);
         } else {
             info.references = NULL;
         }
@@ -727,9 +1531,12 @@ EcsEntity _ecs_run_w_filter(
         info.table_columns = table_columns;
         info.components = ECS_OFFSET(components,
             components_size * table[COMPONENTS_INDEX]);
+        info.changed = changed;
+        info.group = get_group(table);
         info.begin = first;
         info.count = count;
         info.end = first + count;
+        info.padded_end = get_padded_end(real_world, w_table, info.end);
         info.entities = ecs_array_buffer(((EcsTableColumn*)info.table_columns)[0].data);
         
         action(&info);
@@ -757,3 +1564,247 @@ EcsEntity ecs_run(
 {
     return ecs_run_w_filter(world, system, delta_time, 0, 0, 0, param);
 }
+
+void ecs_set_group_by(
+    EcsWorld *world,
+    EcsEntity system,
+    EcsGroupByAction group_by,
+    void *ctx)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    if (system_data) {
+        set_group_by(world, system_data, group_by, ctx);
+    }
+}
+
+void _ecs_set_order_by(
+    EcsWorld *world,
+    EcsEntity system,
+    EcsType component,
+    EcsCompareAction compare)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    if (system_data) {
+        set_order_by(world, system_data, component, compare);
+    }
+}
+
+EcsQuery* ecs_query_new(
+    EcsWorld *world,
+    const char *sig)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(sig != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    EcsQuery *result = malloc(sizeof(EcsQuery));
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    EcsColSystem *system_data = &result->system_data;
+    init_system_data(world, 0, system_data, EcsManual, sig, NULL);
+
+    /* SYSTEM columns are resolved on the system entity, which queries lack */
+    ecs_assert(!system_data->base.and_from_system, 
+        ECS_INVALID_COMPONENT_EXPRESSION, sig);
+
+    uint32_t column_count = ecs_array_count(system_data->base.columns);
+    result->ref_ptrs = malloc(sizeof(void*) * column_count);
+
+    match_tables(world, 0, system_data);
+
+    EcsQuery **elem = ecs_array_add(&world->queries, &query_arr_params);
+    *elem = result;
+
+    return result;
+}
+
+void ecs_query_free(
+    EcsWorld *world,
+    EcsQuery *query)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(query != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    EcsQuery **buffer = ecs_array_buffer(world->queries);
+    uint32_t i, count = ecs_array_count(world->queries);
+
+    for (i = 0; i < count; i ++) {
+        if (buffer[i] == query) {
+            break;
+        }
+    }
+
+    ecs_assert(i != count, ECS_INVALID_PARAMETERS, "unknown query");
+
+    ecs_array_remove_index(world->queries, &query_arr_params, i);
+    ecs_col_system_free(&query->system_data);
+    free(query->ref_ptrs);
+    free(query);
+}
+
+void _ecs_query_order_by(
+    EcsWorld *world,
+    EcsQuery *query,
+    EcsType component,
+    EcsCompareAction compare)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(query != NULL, ECS_INVALID_PARAMETERS, NULL);
+    set_order_by(world, &query->system_data, component, compare);
+}
+
+void ecs_query_group_by(
+    EcsWorld *world,
+    EcsQuery *query,
+    EcsGroupByAction group_by,
+    void *ctx)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(query != NULL, ECS_INVALID_PARAMETERS, NULL);
+    set_group_by(world, &query->system_data, group_by, ctx);
+}
+
+EcsQueryIter ecs_query_iter(
+    EcsWorld *world,
+    EcsQuery *query)
+{
+    ecs_assert(query != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    EcsColSystem *system_data = &query->system_data;
+    EcsWorld *real_world = world;
+    ecs_get_stage(&real_world);
+
+    /* Tables can only be sorted when no worker threads are running */
+    if (!real_world->in_progress || 
+        !ecs_array_count(real_world->worker_threads)) 
+    {
+        group_tables(real_world, system_data);
+
+        if (system_data->compare) {
+            sort_tables(real_world, system_data);
+        }
+    }
+
+    return (EcsQueryIter){
+        .query = query,
+        .index = 0,
+        .rows = {
+            .world = world,
+            .column_count = ecs_array_count(query->system_data.base.columns),
+            .ref_ptrs = query->ref_ptrs,
+            .changed = ~(uint32_t)0
+        }
+    };
+}
+
+bool ecs_query_next(
+    EcsQueryIter *iter)
+{
+    EcsQuery *query = iter->query;
+    EcsColSystem *system_data = &query->system_data;
+    EcsRows *rows = &iter->rows;
+
+    EcsWorld *real_world = rows->world;
+    ecs_get_stage(&real_world);
+
+    EcsArray *tables = system_data->tables;
+    uint32_t count = ecs_array_count(tables);
+    EcsTable *world_tables = ecs_array_buffer(real_world->main_stage.tables);
+
+    /* Sorted queries iterate slices of tables instead of entire tables */
+    EcsTableSlice *slices = NULL;
+    if (system_data->compare) {
+        slices = ecs_array_buffer(system_data->table_slices);
+        count = ecs_array_count(system_data->table_slices);
+    }
+
+    rows->index_offset += rows->count;
+
+    for (; iter->index < count; iter->index ++) {
+        int32_t *table_data = ecs_array_get(tables, &system_data->table_params, 
+            slices ? slices[iter->index].table : iter->index);
+        EcsTable *table = &world_tables[table_data[TABLE_INDEX]];
+        uint32_t first = 0, row_count = ecs_table_count(table);
+
+        /* Rows may have been removed since slices were computed */
+        if (slices) {
+            first = slices[iter->index].begin;
+            if (first >= row_count) {
+                continue;
+            }
+
+            row_count -= first;
+            if (slices[iter->index].count < row_count) {
+                row_count = slices[iter->index].count;
+            }
+        }
+
+        /* Queries are not notified of table activation */
+        if (!row_count) {
+            continue;
+        }
+
+        uint32_t ref_index = table_data[REFS_INDEX];
+        if (ref_index) {
+            /* Same rule as for systems: only update the reference cache if
+             * worker threads cannot be iterating the query too */
+            bool update_refs = !real_world->in_progress || 
+                !ecs_array_count(real_world->worker_threads);
+
+            rows->references = ecs_array_get(
+                system_data->refs, &system_data->ref_params, ref_index - 1);
+
+            resolve_refs(
+                rows->world, system_data, table_data, update_refs, 
+                rows->ref_ptrs);
+        } else {
+            rows->references = NULL;
+        }
+
+        rows->columns = &table_data[COLUMNS_INDEX];
+        rows->table_columns = table->columns;
+        rows->components = ecs_array_get(
+            system_data->components, &system_data->component_params, 
+            table_data[COMPONENTS_INDEX]);
+        rows->entities = ecs_array_buffer(table->columns[0].data);
+        rows->group = get_group(table_data);
+        rows->begin = first;
+        rows->count = row_count;
+        rows->end = first + row_count;
+        rows->padded_end = get_padded_end(real_world, table, rows->end);
+
+        iter->index ++;
+
+        return true;
+    }
+
+    rows->count = 0;
+
+    return false;
+}
+
+void ecs_query_skip_group(
+    EcsQueryIter *iter)
+{
+    EcsColSystem *system_data = &iter->query->system_data;
+    EcsArray *tables = system_data->tables;
+    uint32_t count = ecs_array_count(tables);
+    uint64_t group = iter->rows.group;
+
+    EcsTableSlice *slices = NULL;
+    if (system_data->compare) {
+        slices = ecs_array_buffer(system_data->table_slices);
+        count = ecs_array_count(system_data->table_slices);
+    }
+
+    for (; iter->index < count; iter->index ++) {
+        int32_t *table_data = ecs_array_get(tables, &system_data->table_params, 
+            slices ? slices[iter->index].table : iter->index);
+
+        if (get_group(table_data) != group) {
+            break;
+        }
+    }
+}
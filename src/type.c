@@ -8,6 +8,7 @@ EcsResult add_type(
     EcsWorld *world,
     EcsSystemExprElemKind elem_kind,
     EcsSystemExprOperKind oper_kind,
+    EcsSystemExprInOutKind inout_kind,
     const char *entity_id,
     const char *source_id,
     void *data)
@@ -55,7 +56,9 @@ int compare_handle(
     const void *p1,
     const void *p2)
 {
-    return *(EcsEntity*)p1 - *(EcsEntity*)p2;
+    EcsEntity e1 = *(EcsEntity*)p1;
+    EcsEntity e2 = *(EcsEntity*)p2;
+    return (e1 > e2) - (e1 < e2);
 }
 
 /** Hash array of handles */
@@ -72,19 +75,111 @@ uint32_t hash_handle_array(
     return hash;
 }
 
+/** Find type with the same components in the list of types with a hash */
 static
-void notify_create_type(
+EcsType find_type(
     EcsWorld *world,
-    EcsStage *stage,
-    EcsArray *systems,
-    EcsType type)
+    uint32_t hash,
+    EcsEntity *buf,
+    uint32_t count)
 {
-    EcsEntity *buffer = ecs_array_buffer(systems);
-    uint32_t i, count = ecs_array_count(systems);
+    EcsType type_id = ecs_map_get64(world->type_index, hash);
+
+    while (type_id) {
+        EcsTypeRecord *record = ecs_type_get_record(world, type_id);
+        EcsArray *components = record->components;
+
+        if (ecs_array_count(components) == count && 
+            !memcmp(ecs_array_buffer(components), buf, sizeof(EcsEntity) * count))
+        {
+            break;
+        }
+
+        type_id = record->next;
+    }
+
+    return type_id;
+}
 
+/** Index of lowest bit set in mask */
+static
+uint32_t first_bit(
+    uint64_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#else
+    uint32_t result = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        result ++;
+    }
+    return result;
+#endif
+}
+
+/** Set the bit of a component in a type signature. Returns false if the bit
+ * is not unique to the component. */
+static
+bool signature_add(
+    uint64_t *signature,
+    EcsEntity component)
+{
+    uint32_t bit;
+    bool is_exact = component < ECS_TYPE_SIGNATURE_EXACT;
+
+    if (is_exact) {
+        bit = component;
+    } else {
+        uint32_t bloom_bits = 
+            ECS_TYPE_SIGNATURE_WORDS * 64 - ECS_TYPE_SIGNATURE_EXACT;
+        bit = ECS_TYPE_SIGNATURE_EXACT + 
+            ((component * 0x9E3779B97F4A7C15ULL) >> 32) % bloom_bits;
+    }
+
+    signature[bit / 64] |= 1ULL << (bit % 64);
+
+    return is_exact;
+}
+
+/** Add a new record to the type registry */
+static
+EcsType new_type(
+    EcsWorld *world,
+    uint32_t hash,
+    EcsEntity *buf,
+    uint32_t count)
+{
+    EcsType type_id = world->type_count + 1;
+    uint32_t page = type_id / ECS_TYPE_PAGE_SIZE;
+
+    ecs_assert(page < ECS_MAX_TYPE_PAGES, ECS_OUT_OF_MEMORY, NULL);
+
+    if (!world->type_pages[page]) {
+        world->type_pages[page] = calloc(
+            ECS_TYPE_PAGE_SIZE, sizeof(EcsTypeRecord));
+        ecs_assert(world->type_pages[page] != NULL, ECS_OUT_OF_MEMORY, NULL);
+    }
+
+    EcsTypeRecord *record = ecs_type_get_record(world, type_id);
+    record->components = ecs_array_new_from_buffer(
+        &handle_arr_params, count, buf);
+    record->hash = hash;
+    record->is_exact = true;
+
+    uint32_t i;
     for (i = 0; i < count; i ++) {
-        ecs_row_system_notify_of_type(world, stage, buffer[i], type);
+        record->is_exact &= signature_add(record->signature, buf[i]);
     }
+
+    record->next = ecs_map_get64(world->type_index, hash);
+    ecs_map_set64(world->type_index, hash, type_id);
+
+    /* Only increase the count once the record is initialized, so that other
+     * threads never observe a partially initialized record */
+    world->type_count = type_id;
+
+    return type_id;
 }
 
 static
@@ -94,45 +189,233 @@ EcsType register_type_from_buffer(
     EcsEntity *buf,
     uint32_t count)
 {
-    EcsType new_id = hash_handle_array(buf, count);
-    EcsMap *type_index;
+    uint32_t hash = hash_handle_array(buf, count);
 
-    if (!stage) stage = &world->main_stage;
+    /* Worker threads share the type registry, so lock it while threads may be
+     * registering types concurrently */
+    bool lock = world->threads_running != 0;
+    if (lock) {
+        pthread_mutex_lock(&world->type_mutex);
+    }
 
-    type_index = stage->type_index;
+    EcsType type_id = find_type(world, hash, buf, count);
+    if (!type_id) {
+        type_id = new_type(world, hash, buf, count);
+    }
 
-    EcsArray *new_array = ecs_map_get(type_index, new_id);
+    if (lock) {
+        pthread_mutex_unlock(&world->type_mutex);
+    }
 
-    if (!new_array) {
-        new_array = ecs_array_new_from_buffer(&handle_arr_params, count, buf);
-        ecs_map_set(type_index, new_id,  new_array);
+    return type_id;
+}
 
-        if (!world->in_progress) {
-            notify_create_type(world, stage, world->add_systems, new_id);
-            notify_create_type(world, stage, world->remove_systems, new_id);
-            notify_create_type(world, stage, world->set_systems, new_id);
+/** Walk the prefab chain of a type and store, for each inherited component,
+ * the nearest prefab that owns it. Prefabs are resolved from the main stage. */
+static
+void flatten_prefabs(
+    EcsWorld *world,
+    EcsTypeRecord *record)
+{
+    if (!record->prefab_owners) {
+        record->prefab_owners = ecs_map_new(0);
+    } else {
+        ecs_map_clear(record->prefab_owners);
+    }
+
+    EcsEntity prefab = record->prefab;
+
+    while (prefab) {
+        EcsRow row = ecs_entity_index_get(world->entity_index, prefab);
+        if (!row.type_id) {
+            break;
+        }
+
+        EcsArray *type = ecs_type_get(world, NULL, row.type_id);
+        EcsEntity *buffer = ecs_array_buffer(type);
+        uint32_t i, count = ecs_array_count(type);
+
+        for (i = 0; i < count; i ++) {
+            EcsEntity component = buffer[i];
+            if (component == EEcsId || component == EEcsPrefab) {
+                continue;
+            }
+
+            if (!ecs_map_has(record->prefab_owners, component, NULL)) {
+                ecs_map_set64(record->prefab_owners, component, prefab);
+            }
         }
+
+        prefab = ecs_type_get_prefab(world, row.type_id);
+    }
+
+    record->prefab_version = world->prefab_version;
+}
+
+/** Find the nearest prefab that owns a component without using the cache */
+static
+EcsEntity find_prefab_owner(
+    EcsWorld *world,
+    EcsEntity prefab,
+    EcsEntity component)
+{
+    while (prefab) {
+        EcsRow row = ecs_entity_index_get(world->entity_index, prefab);
+        if (!row.type_id) {
+            break;
+        }
+
+        EcsArray *type = ecs_type_get(world, NULL, row.type_id);
+        EcsEntity *buffer = ecs_array_buffer(type);
+        uint32_t i, count = ecs_array_count(type);
+
+        for (i = 0; i < count; i ++) {
+            if (buffer[i] == component) {
+                return prefab;
+            }
+        }
+
+        prefab = ecs_type_get_prefab(world, row.type_id);
     }
 
-    return new_id;
+    return 0;
 }
 
 /* -- Private functions -- */
 
+void ecs_type_init_registry(
+    EcsWorld *world)
+{
+    memset(world->type_pages, 0, sizeof(world->type_pages));
+    world->type_index = ecs_map_new(0);
+    world->type_count = 0;
+    world->prefab_version = 0;
+    pthread_mutex_init(&world->type_mutex, NULL);
+}
+
+void ecs_type_free_registry(
+    EcsWorld *world)
+{
+    uint32_t i;
+    for (i = 1; i <= world->type_count; i ++) {
+        EcsTypeRecord *record = ecs_type_get_record(world, i);
+        ecs_array_free(record->components);
+        ecs_array_free(record->add_systems);
+        ecs_array_free(record->remove_systems);
+        ecs_array_free(record->set_systems);
+
+        if (record->move_plans) {
+            EcsIter it = ecs_map_iter(record->move_plans);
+            while (ecs_iter_hasnext(&it)) {
+                free(ecs_iter_next(&it));
+            }
+            ecs_map_free(record->move_plans);
+        }
+
+        if (record->prefab_owners) {
+            ecs_map_free(record->prefab_owners);
+        }
+    }
+
+    for (i = 0; i < ECS_MAX_TYPE_PAGES; i ++) {
+        free(world->type_pages[i]);
+    }
+
+    ecs_map_free(world->type_index);
+    pthread_mutex_destroy(&world->type_mutex);
+}
+
+EcsTypeRecord* ecs_type_get_record(
+    EcsWorld *world,
+    EcsType type_id)
+{
+    EcsTypeRecord *page = world->type_pages[type_id / ECS_TYPE_PAGE_SIZE];
+    return &page[type_id % ECS_TYPE_PAGE_SIZE];
+}
+
 EcsArray* ecs_type_get(
     EcsWorld *world,
     EcsStage *stage,
     EcsType type_id)
 {
-    EcsArray *result = ecs_map_get(world->main_stage.type_index, type_id);
-    if (!result) {
-        if (world->threads_running) {
-            assert(stage != NULL);
-            result = ecs_map_get(stage->type_index, type_id);
+    if (!type_id || type_id > world->type_count) {
+        return NULL;
+    }
+
+    return ecs_type_get_record(world, type_id)->components;
+}
+
+EcsEntity ecs_type_get_prefab(
+    EcsWorld *world,
+    EcsType type_id)
+{
+    if (!type_id) {
+        return 0;
+    }
+
+    return ecs_type_get_record(world, type_id)->prefab;
+}
+
+EcsEntity ecs_type_get_prefab_owner(
+    EcsWorld *world,
+    EcsType type_id,
+    EcsEntity component)
+{
+    if (!type_id || component == EEcsId || component == EEcsPrefab) {
+        return 0;
+    }
+
+    EcsTypeRecord *record = ecs_type_get_record(world, type_id);
+    if (!record->prefab) {
+        return 0;
+    }
+
+    /* Worker threads may not write to the type registry, so walk the prefab
+     * chain directly when the cache is stale while threads are running */
+    if (!record->prefab_owners || 
+        record->prefab_version != world->prefab_version) 
+    {
+        if (world->in_progress && world->threads_running) {
+            return find_prefab_owner(world, record->prefab, component);
         }
+
+        flatten_prefabs(world, record);
     }
 
-    return result;
+    return ecs_map_get64(record->prefab_owners, component);
+}
+
+bool ecs_type_is_prefab(
+    EcsWorld *world,
+    EcsType type_id)
+{
+    if (!type_id) {
+        return false;
+    }
+
+    EcsTypeRecord *record = ecs_type_get_record(world, type_id);
+    return (record->signature[EEcsPrefab / 64] & 
+        (1ULL << (EEcsPrefab % 64))) != 0;
+}
+
+EcsArray** ecs_type_get_row_systems(
+    EcsWorld *world,
+    EcsType type_id,
+    EcsSystemKind kind)
+{
+    EcsTypeRecord *record = ecs_type_get_record(world, type_id);
+
+    if (kind == EcsOnAdd) {
+        return &record->add_systems;
+    } else if (kind == EcsOnRemove) {
+        return &record->remove_systems;
+    } else if (kind == EcsOnSet) {
+        return &record->set_systems;
+    } else {
+        ecs_abort(ECS_INVALID_PARAMETERS, NULL);
+    }
+
+    return NULL;
 }
 
 /** Get type id from entity handle */
@@ -153,15 +436,14 @@ EcsType ecs_type_from_handle(
     EcsType type = 0;
 
     if (!info) {
-        uint64_t row_64 = ecs_map_get64(world->main_stage.entity_index, entity);
-        if (!row_64 && world->in_progress) {
-            row_64 = ecs_map_get64(stage->entity_index, entity);
-            if (!row_64) {
+        EcsRow row = ecs_entity_index_get(world->entity_index, entity);
+        if (!row.type_id && world->in_progress) {
+            row = ecs_to_row(ecs_map_get64(stage->entity_index, entity));
+            if (!row.type_id) {
                 return 0;
             }
         }
 
-        EcsRow row = ecs_to_row(row_64);
         if (row.type_id) {
             table = ecs_world_get_table(world, stage, row.type_id);
             columns = table->columns;
@@ -362,6 +644,50 @@ EcsEntity ecs_type_contains(
         return *(EcsEntity*)ecs_array_get(f_1, &handle_arr_params, 0);
     }
 
+    /* Test signatures first. If a prefab may provide components, the slow path
+     * is always taken as the prefab type has to be searched as well. */
+    EcsTypeRecord *r_1 = ecs_type_get_record(world, type_id_1);
+    EcsTypeRecord *r_2 = ecs_type_get_record(world, type_id_2);
+
+    if (!match_prefab || !r_1->prefab) {
+        uint64_t missing = 0, common = 0;
+        uint32_t w;
+
+        for (w = 0; w < ECS_TYPE_SIGNATURE_WORDS; w ++) {
+            missing |= r_2->signature[w] & ~r_1->signature[w];
+        }
+
+        if (match_all) {
+            /* Type 2 has a component that type 1 definitely does not have */
+            if (missing) {
+                return 0;
+            }
+
+            /* All components of type 2 are exact, so they are in type 1 */
+            if (r_2->is_exact) {
+                return *(EcsEntity*)ecs_array_last(f_2, &handle_arr_params);
+            }
+        } else {
+            /* Exact bits are ordered like the sorted components, so the lowest
+             * common exact bit is the first component of type 2 in type 1 */
+            for (w = 0; w < ECS_TYPE_SIGNATURE_EXACT / 64; w ++) {
+                common = r_1->signature[w] & r_2->signature[w];
+                if (common) {
+                    return w * 64 + first_bit(common);
+                }
+            }
+
+            for (; w < ECS_TYPE_SIGNATURE_WORDS; w ++) {
+                common |= r_1->signature[w] & r_2->signature[w];
+            }
+
+            /* No component of type 2 is in type 1 */
+            if (!common) {
+                return 0;
+            }
+        }
+    }
+
     uint32_t i_2, i_1 = 0;
     EcsEntity *h2p, *h1p = ecs_array_get(f_1, &handle_arr_params, i_1);
     EcsEntity h1 = 0, prefab = 0;
@@ -385,7 +711,7 @@ EcsEntity ecs_type_contains(
 
         if (h1 != h2) {
             if (match_prefab && !prefab_searched) {
-                prefab = ecs_map_get64(world->prefab_index, type_id_1);
+                prefab = ecs_type_get_prefab(world, type_id_1);
                 prefab_searched = true;
             }
 
@@ -435,7 +761,7 @@ bool ecs_type_contains_component(
     }
 
     if (match_prefab) {
-        EcsEntity prefab = ecs_map_get64(world->prefab_index, type_id);
+        EcsEntity prefab = ecs_type_get_prefab(world, type_id);
         if (prefab) {
             EcsType component_type = ecs_type_from_entity(world, component);
             if (_ecs_has(world, prefab, component_type)) {
@@ -31,8 +31,16 @@ void* ecs_worker(void *arg) {
         pthread_mutex_unlock(&world->thread_mutex);
 
         for (i = 0; i < job_count; i ++) {
-            ecs_run_w_filter(world, 
-                jobs[i]->system, world->delta_time, jobs[i]->offset, jobs[i]->limit, 0, NULL);
+            /* A limit of zero would process all rows after the offset. The
+             * system runs on the thread and not on the world, so that the
+             * operations it does are stored in the stage of the thread. The
+             * temporary stage of the world is not safe to use from multiple
+             * threads. Thread stages are merged at the end of the frame. */
+            if (jobs[i]->limit) {
+                ecs_run_w_filter((EcsWorld*)thread, jobs[i]->system, 
+                    world->delta_time, jobs[i]->offset, jobs[i]->limit, 0, 
+                    NULL);
+            }
         }
 
         pthread_mutex_lock(&world->thread_mutex);
@@ -167,6 +175,57 @@ void create_jobs(
     }
 }
 
+/** Round offset down to a row that is a multiple of width in its table. The
+ * offset is relative to the first row of the first table of the system. */
+static
+uint32_t align_offset(
+    EcsWorld *world,
+    EcsColSystem *system_data,
+    uint32_t offset,
+    uint32_t width)
+{
+    uint32_t table_start = 0;
+
+    EcsIter table_it = ecs_array_iter(
+        system_data->tables, &system_data->table_params);
+
+    while (ecs_iter_hasnext(&table_it)) {
+        uint32_t table_index = *(uint32_t*)ecs_iter_next(&table_it);
+        EcsTable *table = ecs_array_get(
+            world->main_stage.tables, &table_arr_params, table_index);
+        uint32_t count = ecs_array_count(table->columns[0].data);
+
+        if (offset < table_start + count) {
+            return table_start + ((offset - table_start) / width) * width;
+        }
+
+        table_start += count;
+    }
+
+    return offset;
+}
+
+/** Move job boundaries to rows that are a multiple of the SIMD width. A job
+ * that has no rows left after aligning is not ran. */
+static
+void align_jobs(
+    EcsWorld *world,
+    EcsColSystem *system_data,
+    uint32_t total_rows,
+    uint32_t width)
+{
+    EcsJob *jobs = ecs_array_buffer(system_data->jobs);
+    uint32_t i, count = ecs_array_count(system_data->jobs);
+
+    for (i = 1; i < count; i ++) {
+        jobs[i].offset = align_offset(world, system_data, jobs[i].offset, width);
+    }
+
+    for (i = 0; i < count; i ++) {
+        uint32_t end = i < count - 1 ? jobs[i + 1].offset : total_rows;
+        jobs[i].limit = end - jobs[i].offset;
+    }
+}
 
 /* -- Private functions -- */
 
@@ -197,18 +256,15 @@ void ecs_schedule_jobs(
         create_jobs(system_data, thread_count);
     }
 
+    /* Active tables can be empty when table activation is deferred */
+    if (!thread_count) {
+        return;
+    }
+
     float rows_per_thread = (float)total_rows / (float)thread_count;
     float residual = 0;
     int32_t rows_per_thread_i = rows_per_thread;
 
-    table_it = ecs_array_iter(system_data->tables, &system_data->table_params);
-
-    uint32_t sys_table_index = 0;
-    uint32_t table_index = *(uint32_t*)ecs_array_get(
-        system_data->tables, &system_data->table_params, 0);
-    EcsTable *table = ecs_array_get(
-        world->main_stage.tables, &table_arr_params, table_index);
-    uint32_t table_row_count = ecs_array_count(table->columns[0].data);
     uint32_t start_index = 0;
 
     EcsJob *job = NULL;
@@ -224,30 +280,22 @@ void ecs_schedule_jobs(
 
         job->system = system;
         job->system_data = system_data;
-        job->table_index = sys_table_index;
         job->offset = start_index;
         job->limit = rows_per_job;
 
+        /* Job offsets are relative to the first row of the first table,
+         * and may span multiple (possibly empty) tables */
         start_index += rows_per_job;
-
-        while (start_index > table_row_count) {
-            sys_table_index ++;
-            table_index = *(uint32_t*)ecs_array_get(
-                system_data->tables, &system_data->table_params, sys_table_index);
-            table = ecs_array_get(
-                world->main_stage.tables, &table_arr_params, table_index);
-            table_row_count = ecs_array_count(table->columns[0].data);
-            if (start_index > table_row_count) {
-                start_index -= table_row_count;
-            } else {
-                start_index = 0;
-            }
-        }
     }
 
     if (residual >= 0.9) {
         job->limit ++;
     }
+
+    /* Sorted systems iterate slices of tables, which are not aligned */
+    if (world->simd_width && !system_data->compare) {
+        align_jobs(world, system_data, total_rows, world->simd_width);
+    }
 }
 
 /** Assign jobs to worker threads, signal workers */
@@ -287,7 +335,10 @@ void ecs_run_jobs(
     uint32_t i, job_count = thread->job_count;
 
     for (i = 0; i < job_count; i ++) {
-        ecs_run_w_filter(world, jobs[i]->system, world->delta_time, jobs[i]->offset, jobs[i]->limit, 0, NULL);
+        if (jobs[i]->limit) {
+            ecs_run_w_filter(world, jobs[i]->system, world->delta_time, 
+                jobs[i]->offset, jobs[i]->limit, 0, NULL);
+        }
     }
     thread->job_count = 0;
 
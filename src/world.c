@@ -16,6 +16,10 @@ const EcsArrayParams handle_arr_params = {
     .element_size = sizeof(EcsEntity)
 };
 
+const EcsArrayParams type_arr_params = {
+    .element_size = sizeof(EcsType)
+};
+
 const EcsArrayParams stage_arr_params = {
     .element_size = sizeof(EcsStage)
 };
@@ -25,6 +29,7 @@ const EcsArrayParams char_arr_params = {
 };
 
 
+
 /* -- Global variables -- */
 
 EcsType TEcsComponent;
@@ -46,13 +51,38 @@ const char *ECS_HIDDEN_ID =         "EcsHidden";
 const char *ECS_CONTAINER_ID =      "EcsContainer";
 
 
-/** Comparator function for handles */
+/** Get table for type in stage. Tables are stored at the index of their type
+ * id, which means that slots for types without a table are empty. */
 static
-int compare_handle(
-    const void *p1,
-    const void *p2)
+EcsTable* get_table(
+    EcsStage *stage,
+    EcsType type_id)
 {
-    return *(EcsEntity*)p1 - *(EcsEntity*)p2;
+    EcsArray *tables = stage->tables;
+    if (type_id < ecs_array_count(tables)) {
+        EcsTable *table = &((EcsTable*)ecs_array_buffer(tables))[type_id];
+        if (table->type) {
+            return table;
+        }
+    }
+
+    return NULL;
+}
+
+/** Get empty slot for table of type in stage */
+static
+EcsTable* new_table_slot(
+    EcsStage *stage,
+    EcsType type_id)
+{
+    uint32_t count = ecs_array_count(stage->tables);
+    if (type_id >= count) {
+        ecs_array_set_count(&stage->tables, &table_arr_params, type_id + 1);
+        EcsTable *buffer = ecs_array_buffer(stage->tables);
+        memset(&buffer[count], 0, (type_id + 1 - count) * sizeof(EcsTable));
+    }
+
+    return &((EcsTable*)ecs_array_buffer(stage->tables))[type_id];
 }
 
 /** Bootstrap builtin component types and commonly used types */
@@ -85,26 +115,32 @@ EcsTable* bootstrap_component_table(
     EcsWorld *world)
 {
     EcsStage *stage = &world->main_stage;
-    EcsTable *result = ecs_array_add(&stage->tables, &table_arr_params);
-    EcsArray *type = ecs_map_get(stage->type_index, world->t_component);
+    EcsTable *result = new_table_slot(stage, world->t_component);
+    EcsArray *type = ecs_type_get(world, stage, world->t_component);
     result->type_id = world->t_component;
     result->type = type;
     result->frame_systems = NULL;
-    result->columns = malloc(sizeof(EcsTableColumn) * 3);
+    result->add_edges = NULL;
+    result->remove_edges = NULL;
+    result->columns = calloc(3, sizeof(EcsTableColumn));
     result->columns[0].data = ecs_array_new(&handle_arr_params, 8);
     result->columns[0].size = sizeof(EcsEntity);
     result->columns[1].data = ecs_array_new(&handle_arr_params, 8);
     result->columns[1].size = sizeof(EcsComponent);
     result->columns[2].data = ecs_array_new(&handle_arr_params, 8);
     result->columns[2].size = sizeof(EcsId);
+    ecs_table_init_column_index(result);
 
-    uint32_t index = ecs_array_get_index(
-        stage->tables, &table_arr_params, result);
-
-    ecs_assert(index == 0, ECS_INTERNAL_ERROR, "first table index must be 0");
-
-    ecs_map_set64(stage->table_index, world->t_component, 1);
+    return result;
+}
 
+/** Hash of an entity id, used as key in the name index */
+static
+uint32_t name_hash(
+    const char *id)
+{
+    uint32_t result = 0;
+    ecs_hash(id, strlen(id), &result);
     return result;
 }
 
@@ -117,14 +153,12 @@ void bootstrap_component(
     const char *id,
     size_t size)
 {
-    EcsStage *stage = &world->main_stage;
-
     /* Insert row into table to store EcsComponent itself */
     int32_t index = ecs_table_insert(world, table, table->columns, entity);
 
     /* Create record in entity index */
     EcsRow row = {.type_id = world->t_component, .index = index};
-    ecs_map_set(stage->entity_index, entity, ecs_from_row(row));
+    ecs_entity_index_set(world->entity_index, entity, row);
 
     /* Set size and id */
     EcsComponent *component_data = ecs_array_buffer(table->columns[1].data);
@@ -132,34 +166,8 @@ void bootstrap_component(
     
     component_data[index].size = size;
     id_data[index] = id;
-}
-
-static
-void notify_create_table(
-    EcsWorld *world,
-    EcsArray *systems,
-    EcsTable *table)
-{
-    EcsEntity *buffer = ecs_array_buffer(systems);
-    uint32_t i, count = ecs_array_count(systems);
-
-    for (i = 0; i < count; i ++) {
-        ecs_col_system_notify_of_table(world, buffer[i], table);
-    }
-}
 
-static
-void notify_systems_of_table(
-    EcsWorld *world,
-    EcsTable *table)
-{
-    notify_create_table(world, world->pre_frame_systems, table);
-    notify_create_table(world, world->post_frame_systems, table);
-    notify_create_table(world, world->on_load_systems, table);
-    notify_create_table(world, world->on_store_systems, table);
-    notify_create_table(world, world->on_frame_systems, table);
-    notify_create_table(world, world->inactive_systems, table);
-    notify_create_table(world, world->on_demand_systems, table);
+    ecs_world_register_name(world, entity, id);
 }
 
 /** Create a new table and register it with the world and systems. A table in
@@ -171,7 +179,7 @@ EcsTable* create_table(
     EcsType type_id)
 {
     /* Add and initialize table */
-    EcsTable *result = ecs_array_add(&stage->tables, &table_arr_params);
+    EcsTable *result = new_table_slot(stage, type_id);
     
     result->type_id = type_id;
 
@@ -179,11 +187,8 @@ EcsTable* create_table(
         return NULL;
     }
 
-    uint32_t index = ecs_array_get_index(stage->tables, &table_arr_params, result);
-    ecs_map_set64(stage->table_index, type_id, index + 1);
-
     if (stage == &world->main_stage) {
-        notify_systems_of_table(world, result);
+        ecs_notify_col_systems_of_table(world, result);
     }
 
     assert(result != NULL);
@@ -193,32 +198,61 @@ EcsTable* create_table(
 
 /* -- Private functions -- */
 
+void ecs_world_register_name(
+    EcsWorld *world,
+    EcsEntity entity,
+    const char *id)
+{
+    if (!id) {
+        return;
+    }
+
+    uint32_t hash = name_hash(id);
+
+    bool lock = world->threads_running != 0;
+    if (lock) {
+        pthread_mutex_lock(&world->name_mutex);
+    }
+
+    EcsArray *entities = ecs_map_get(world->name_index, hash);
+    EcsEntity *buffer = ecs_array_buffer(entities);
+    uint32_t i, count = ecs_array_count(entities);
+
+    for (i = 0; i < count; i ++) {
+        if (buffer[i] == entity) {
+            break;
+        }
+    }
+
+    if (i == count) {
+        EcsEntity *elem = ecs_array_add(&entities, &handle_arr_params);
+        *elem = entity;
+        ecs_map_set(world->name_index, hash, entities);
+    }
+
+    if (lock) {
+        pthread_mutex_unlock(&world->name_mutex);
+    }
+}
+
 /** Get pointer to table data from type id */
 EcsTable* ecs_world_get_table(
     EcsWorld *world,
     EcsStage *stage,
     EcsType type_id)
 {
-    EcsStage *main_stage = &world->main_stage;
-    uint32_t table_index = ecs_map_get64(main_stage->table_index, type_id);
+    EcsTable *table = get_table(&world->main_stage, type_id);
 
-    if (!table_index && world->in_progress) {
+    if (!table && world->in_progress) {
         assert(stage != NULL);
-        table_index = ecs_map_get64(stage->table_index, type_id);
-        if (table_index) {
-            return ecs_array_get(
-                stage->tables, &table_arr_params, table_index - 1);
-        }
+        table = get_table(stage, type_id);
     }
 
-    if (table_index) {
-        return ecs_array_get(
-            main_stage->tables, &table_arr_params, table_index - 1);
-    } else {
-        return create_table(world, stage, type_id);
+    if (!table) {
+        table = create_table(world, stage, type_id);
     }
 
-    return NULL;
+    return table;
 }
 
 static
@@ -245,6 +279,96 @@ EcsArray** frame_system_array(
     return NULL;
 }
 
+/** Get creation sequence of a system, which determines its order in arrays */
+static
+uint32_t system_order(
+    EcsWorld *world,
+    EcsEntity system)
+{
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    assert(system_data != NULL);
+    return system_data->base.order;
+}
+
+/** Find system in array sorted by creation order. Returns -1 if not found. */
+static
+int32_t find_system(
+    EcsWorld *world,
+    EcsArray *systems,
+    EcsEntity system)
+{
+    EcsEntity *buffer = ecs_array_buffer(systems);
+    int32_t low = 0, high = ecs_array_count(systems) - 1;
+    uint32_t order = system_order(world, system);
+
+    while (low <= high) {
+        int32_t mid = low + (high - low) / 2;
+        uint32_t mid_order = system_order(world, buffer[mid]);
+        if (mid_order == order) {
+            return mid;
+        } else if (mid_order < order) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    return -1;
+}
+
+/** Remove system from sorted array, while preserving order */
+static
+void remove_system(
+    EcsArray *systems,
+    int32_t index)
+{
+    EcsEntity *buffer = ecs_array_buffer(systems);
+    uint32_t count = ecs_array_count(systems);
+
+    memmove(&buffer[index], &buffer[index + 1], 
+        (count - index - 1) * sizeof(EcsEntity));
+
+    ecs_array_remove_last(systems);
+}
+
+/** Insert system in array sorted by creation order */
+static
+void insert_system(
+    EcsWorld *world,
+    EcsArray **systems,
+    EcsEntity system)
+{
+    ecs_array_add(systems, &handle_arr_params);
+
+    EcsEntity *buffer = ecs_array_buffer(*systems);
+    int32_t i = ecs_array_count(*systems) - 1;
+    uint32_t order = system_order(world, system);
+
+    /* Systems are typically activated in creation order, which means that
+     * the insertion point is usually at or near the end of the array */
+    while (i && system_order(world, buffer[i - 1]) > order) {
+        buffer[i] = buffer[i - 1];
+        i --;
+    }
+
+    buffer[i] = system;
+}
+
+void ecs_world_add_system(
+    EcsWorld *world,
+    EcsEntity system,
+    EcsSystemKind kind,
+    bool active)
+{
+    /* Arrays are ordered by creation sequence and not by handle, as recycled
+     * handles can be larger than the handles of systems created later */
+    if (active || kind == EcsManual) {
+        insert_system(world, frame_system_array(world, kind), system);
+    } else {
+        insert_system(world, &world->inactive_systems, system);
+    }
+}
+
 /** Inactive systems are systems that either:
  * - are not enabled
  * - matched with no tables
@@ -269,31 +393,18 @@ void ecs_world_activate_system(
         dst_array = world->inactive_systems;
     }
 
-    uint32_t count = ecs_array_count(src_array);
-    int i;
-    for (i = 0; i < count; i ++) {
-        EcsEntity *h = ecs_array_get(
-            src_array, &handle_arr_params, i);
-        if (*h == system) {
-            break;
-        }
-    }
-
-    if (i == count) {
+    int32_t i = find_system(world, src_array, system);
+    if (i == -1) {
         return; /* System is disabled */
     }
 
-    ecs_array_move_index(
-        &dst_array, src_array, &handle_arr_params, i);
+    remove_system(src_array, i);
+    insert_system(world, &dst_array, system);
 
     if (active) {
-         *frame_system_array(world, kind) = dst_array;
-         qsort(dst_array, ecs_array_count(dst_array) + 1,
-          sizeof(EcsEntity), compare_handle);
+        *frame_system_array(world, kind) = dst_array;
     } else {
         world->inactive_systems = dst_array;
-        qsort(src_array, ecs_array_count(src_array) + 1,
-          sizeof(EcsEntity), compare_handle);
     }
 }
 
@@ -379,6 +490,18 @@ EcsStage *ecs_get_stage(
     }
 }
 
+/** Free index that stores arrays of systems by component */
+static
+void free_system_index(
+    EcsMap *index)
+{
+    EcsIter it = ecs_map_iter(index);
+    while (ecs_iter_hasnext(&it)) {
+        ecs_array_free(ecs_iter_next(&it));
+    }
+    ecs_map_free(index);
+}
+
 static
 void col_systems_deinit(
     EcsWorld *world,
@@ -389,12 +512,7 @@ void col_systems_deinit(
 
     for (i = 0; i < count; i ++) {
         EcsColSystem *ptr = ecs_get_ptr(world, buffer[i], EcsColSystem);
-        ecs_array_free(ptr->base.columns);
-        ecs_array_free(ptr->components);
-        ecs_array_free(ptr->inactive_tables);
-        ecs_array_free(ptr->jobs);
-        ecs_array_free(ptr->tables);
-        ecs_array_free(ptr->refs);
+        ecs_col_system_free(ptr);
     }
 }
 
@@ -411,6 +529,10 @@ EcsWorld *ecs_init(void) {
     world->on_store_systems = ecs_array_new( &handle_arr_params, 0);
     world->inactive_systems = ecs_array_new(&handle_arr_params, 0);
     world->on_demand_systems = ecs_array_new(&handle_arr_params, 0);
+    world->dirty_tables = ecs_array_new(&type_arr_params, 0);
+    world->deactivation_delay = 0;
+    world->simd_width = 0;
+    world->queries = ecs_array_new(&query_arr_params, 0);
 
     world->add_systems = ecs_array_new(&handle_arr_params, 0);
     world->remove_systems = ecs_array_new(&handle_arr_params, 0);
@@ -418,21 +540,27 @@ EcsWorld *ecs_init(void) {
     world->tasks = ecs_array_new(&handle_arr_params, 0);
     world->fini_tasks = ecs_array_new(&handle_arr_params, 0);
 
-    world->type_sys_add_index = ecs_map_new(0);
-    world->type_sys_remove_index = ecs_map_new(0);
-    world->type_sys_set_index = ecs_map_new(0);
     world->type_handles = ecs_map_new(0);
-    world->prefab_index = ecs_map_new(0);
+    world->name_index = ecs_map_new(0);
+    pthread_mutex_init(&world->name_mutex, NULL);
+    world->component_systems = ecs_map_new(0);
+    world->add_triggers = ecs_map_new(0);
+    world->remove_triggers = ecs_map_new(0);
+    world->set_triggers = ecs_map_new(0);
+    world->trigger_version = 1;
+    world->system_order = 0;
 
     world->worker_stages = NULL;
     world->worker_threads = NULL;
     world->jobs_finished = 0;
     world->threads_running = 0;
+    world->change_version = 1;
     world->valid_schedule = false;
     world->quit_workers = false;
     world->in_progress = false;
     world->is_merging = false;
     world->auto_merge = true;
+    world->deferred_activation = false;
     world->measure_frame_time = false;
     world->measure_system_time = false;
     world->last_handle = 0;
@@ -445,6 +573,8 @@ EcsWorld *ecs_init(void) {
     world->fps_sleep = 0;
     world->tick = 0;
 
+    ecs_type_init_registry(world);
+    world->entity_index = ecs_entity_index_new();
     ecs_stage_init(world, &world->main_stage);
     ecs_stage_init(world, &world->temp_stage);
 
@@ -497,6 +627,12 @@ EcsResult ecs_fini(
     col_systems_deinit(world, world->on_demand_systems);
     col_systems_deinit(world, world->inactive_systems);
 
+    /* Free queries that were not freed by the application */
+    while (ecs_array_count(world->queries)) {
+        EcsQuery **query = ecs_array_last(world->queries, &query_arr_params);
+        ecs_query_free(world, *query);
+    }
+
     ecs_stage_deinit(world, &world->main_stage);
     ecs_stage_deinit(world, &world->temp_stage);
 
@@ -508,6 +644,8 @@ EcsResult ecs_fini(
 
     ecs_array_free(world->inactive_systems);
     ecs_array_free(world->on_demand_systems);
+    ecs_array_free(world->dirty_tables);
+    ecs_array_free(world->queries);
     ecs_array_free(world->tasks);
     ecs_array_free(world->fini_tasks);
 
@@ -515,12 +653,23 @@ EcsResult ecs_fini(
     ecs_array_free(world->remove_systems);
     ecs_array_free(world->set_systems);
 
-    ecs_map_free(world->prefab_index);
-    ecs_map_free(world->type_sys_add_index);
-    ecs_map_free(world->type_sys_remove_index);
-    ecs_map_free(world->type_sys_set_index);
     ecs_map_free(world->type_handles);
 
+    EcsIter it = ecs_map_iter(world->name_index);
+    while (ecs_iter_hasnext(&it)) {
+        ecs_array_free(ecs_iter_next(&it));
+    }
+    ecs_map_free(world->name_index);
+    pthread_mutex_destroy(&world->name_mutex);
+
+    free_system_index(world->component_systems);
+    free_system_index(world->add_triggers);
+    free_system_index(world->remove_triggers);
+    free_system_index(world->set_triggers);
+
+    ecs_type_free_registry(world);
+    ecs_entity_index_free(world->entity_index);
+
     world->magic = 0;
 
     free(world);
@@ -533,7 +682,8 @@ void ecs_dim(
     uint32_t entity_count)
 {
     assert(world->magic == ECS_WORLD_MAGIC);
-    ecs_map_set_size(world->main_stage.entity_index, entity_count);
+    ecs_entity_index_set_size(
+        world->entity_index, world->last_handle + 1, entity_count);
 }
 
 void _ecs_dim_type(
@@ -545,7 +695,7 @@ void _ecs_dim_type(
     if (type) {
         EcsTable *table = ecs_world_get_table(world, &world->main_stage, type);
         if (table) {
-            ecs_table_dim(table, entity_count);
+            ecs_table_dim(world, table, entity_count);
         }
     }
 }
@@ -554,30 +704,93 @@ EcsEntity ecs_lookup(
     EcsWorld *world,
     const char *id)
 {
-    EcsIter it = ecs_array_iter(world->main_stage.tables, &table_arr_params);
+    return ecs_lookup_child(world, 0, id);
+}
 
-    while (ecs_iter_hasnext(&it)) {
-        EcsTable *table = ecs_iter_next(&it);
-        uint32_t column_index;
+EcsEntity ecs_lookup_child(
+    EcsWorld *world,
+    EcsEntity parent,
+    const char *id)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(id != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    EcsWorld *real_world = world;
+    ecs_get_stage(&real_world);
+
+    uint32_t hash = name_hash(id);
+    EcsEntity result = 0;
+
+    bool lock = real_world->threads_running != 0;
+    if (lock) {
+        pthread_mutex_lock(&real_world->name_mutex);
+    }
+
+    EcsArray *entities = ecs_map_get(real_world->name_index, hash);
+    EcsEntity *buffer = ecs_array_buffer(entities);
+    uint32_t i, count = ecs_array_count(entities);
+
+    for (i = 0; i < count; i ++) {
+        EcsEntity e = buffer[i];
+        EcsId *e_id = NULL;
+
+        if (ecs_is_alive(world, e)) {
+            e_id = ecs_get_ptr(world, e, EcsId);
+        }
 
-        if ((column_index = ecs_type_index_of(table->type, EEcsId)) == -1) {
+        /* Entities are not removed from the index when they are deleted, or
+         * when their id is removed or changed. Clean up such entries now. */
+        if (!e_id || !*e_id || name_hash(*e_id) != hash) {
+            ecs_array_remove_index(entities, &handle_arr_params, i);
+            i --;
+            count --;
             continue;
         }
 
+        if (strcmp(*e_id, id)) {
+            continue;
+        }
 
-        EcsTableColumn *column = &table->columns[column_index + 1];
-        EcsId *buffer = ecs_array_buffer(column->data);
-        uint32_t i, count = ecs_array_count(column->data);
-        
-        for (i = 0; i < count; i ++) {
-            if (!strcmp(buffer[i], id)) {
-                return *(EcsEntity*)ecs_array_get(
-                    table->columns[0].data, &handle_arr_params, i);
-            }
+        if (parent && !ecs_contains(world, parent, e)) {
+            continue;
         }
+
+        result = e;
+        break;
     }
 
-    return 0;
+    if (lock) {
+        pthread_mutex_unlock(&real_world->name_mutex);
+    }
+
+    return result;
+}
+
+EcsEntity ecs_lookup_path(
+    EcsWorld *world,
+    const char *path)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(path != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    char *buffer = strdup(path);
+    char *id = buffer, *sep;
+    EcsEntity result = 0;
+
+    do {
+        if ((sep = strchr(id, '.'))) {
+            *sep = '\0';
+        }
+
+        result = ecs_lookup_child(world, result, id);
+        if (sep) {
+            id = sep + 1;
+        }
+    } while (result && sep);
+
+    free(buffer);
+
+    return result;
 }
 
 static
@@ -587,6 +800,7 @@ void run_single_thread_stage(
     float delta_time)
 {
     uint32_t i, system_count = ecs_array_count(systems);
+    bool has_threads = ecs_array_count(world->worker_threads) != 0;
 
     if (system_count) {
         EcsEntity *buffer = ecs_array_buffer(systems);
@@ -594,6 +808,14 @@ void run_single_thread_stage(
         world->in_progress = true;
 
         for (i = 0; i < system_count; i ++) {
+            /* If the world has worker threads, references are not updated by
+             * the system itself */
+            if (has_threads) {
+                ecs_col_system_sort_tables(world, buffer[i]);
+                ecs_col_system_resolve_refs(world, buffer[i]);
+                ecs_col_system_track_changes(world, buffer[i]);
+            }
+
             ecs_run(world, buffer[i], delta_time, NULL);
         }
 
@@ -614,15 +836,23 @@ void run_multi_thread_stage(
     /* Run periodic table systems */
     uint32_t i, system_count = ecs_array_count(systems);
     if (system_count) {
-        bool valid_schedule = world->valid_schedule;
         EcsEntity *buffer = ecs_array_buffer(systems);
 
         world->in_progress = true;
 
         for (i = 0; i < system_count; i ++) {
-            if (!valid_schedule) {
+            /* Job offsets depend on the order of tables, so tables are
+             * ordered first. Reordering invalidates the schedule. */
+            ecs_col_system_sort_tables(world, buffer[i]);
+
+            if (!world->valid_schedule) {
                 ecs_schedule_jobs(world, buffer[i]);
             }
+
+            /* Workers only read cached references, so update them before
+             * the jobs start */
+            ecs_col_system_resolve_refs(world, buffer[i]);
+            ecs_col_system_track_changes(world, buffer[i]);
             ecs_prepare_jobs(world, buffer[i]);
         }
         ecs_run_jobs(world);
@@ -712,6 +942,12 @@ bool ecs_progress(
     bool measure_frame_time = world->measure_frame_time;
     bool has_threads = ecs_array_count(world->worker_threads) != 0;
 
+    /* Apply table (de)activations that were deferred since the last frame,
+     * before systems are ran and jobs are scheduled */
+    if (ecs_array_count(world->dirty_tables)) {
+        ecs_table_activate_dirty(world);
+    }
+
     /* -- System execution starts here -- */
 
     run_single_thread_stage(world, world->on_load_systems, delta_time);
@@ -814,6 +1050,58 @@ void ecs_set_target_fps(
     world->target_fps = fps;
 }
 
+void ecs_set_deferred_activation(
+    EcsWorld *world,
+    bool enabled)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    world->deferred_activation = enabled;
+
+    /* Bring tables in sync with their systems when leaving deferred mode */
+    if (!enabled) {
+        ecs_table_activate_dirty(world);
+    }
+}
+
+void ecs_set_deactivation_delay(
+    EcsWorld *world,
+    uint32_t frames)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    world->deactivation_delay = frames;
+}
+
+void ecs_set_simd_width(
+    EcsWorld *world,
+    uint32_t width)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(!(width & (width - 1)), ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(width <= ECS_COLUMN_ALIGNMENT, ECS_INVALID_PARAMETERS, NULL);
+
+    if (world->simd_width == width) {
+        return;
+    }
+
+    world->simd_width = width;
+
+    /* Copy existing columns to buffers with the new alignment and padding.
+     * When the width is reset, existing columns keep their alignment. */
+    if (width) {
+        EcsTable *buffer = ecs_array_buffer(world->main_stage.tables);
+        uint32_t i, count = ecs_array_count(world->main_stage.tables);
+
+        for (i = 0; i < count; i ++) {
+            if (buffer[i].type) {
+                ecs_table_realign(world, &buffer[i]);
+            }
+        }
+    }
+}
+
 void* ecs_get_context(
     EcsWorld *world)
 {
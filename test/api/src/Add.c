@@ -454,3 +454,134 @@ void Add_type_w_tag_mixed() {
 
     ecs_fini(world);
 }
+
+void Add_tag_to_entities_in_same_table() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    EcsEntity e_1 = ecs_new(world, Position);
+    EcsEntity e_2 = ecs_new(world, Position);
+    test_assert(e_1 != 0);
+    test_assert(e_2 != 0);
+
+    ecs_add(world, e_1, Tag);
+    ecs_add(world, e_2, Tag);
+    test_assert(ecs_has(world, e_1, Position));
+    test_assert(ecs_has(world, e_1, Tag));
+    test_assert(ecs_has(world, e_2, Position));
+    test_assert(ecs_has(world, e_2, Tag));
+
+    ecs_remove(world, e_1, Tag);
+    ecs_remove(world, e_2, Tag);
+    test_assert(ecs_has(world, e_1, Position));
+    test_assert(!ecs_has(world, e_1, Tag));
+    test_assert(ecs_has(world, e_2, Position));
+    test_assert(!ecs_has(world, e_2, Tag));
+
+    ecs_add(world, e_1, Tag);
+    test_assert(ecs_has(world, e_1, Tag));
+    test_assert(!ecs_has(world, e_2, Tag));
+    
+    ecs_fini(world);
+}
+
+void Add_w_filter() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {10, 20});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {30, 40});
+    EcsEntity e_3 = ecs_new(world, Velocity);
+
+    ecs_add_w_filter(world, Tag, Position);
+
+    test_assert(ecs_has(world, e_1, Tag));
+    test_assert(ecs_has(world, e_2, Tag));
+    test_assert(!ecs_has(world, e_3, Tag));
+
+    Position *p = ecs_get_ptr(world, e_1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get_ptr(world, e_2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void Add_w_filter_to_existing_table() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {10, 20});
+    EcsEntity e_2 = ecs_new(world, Type);
+    ecs_set(world, e_2, Position, {30, 40});
+
+    ecs_add_w_filter(world, Velocity, Position);
+
+    test_assert(ecs_has(world, e_1, Velocity));
+    test_assert(ecs_has(world, e_2, Velocity));
+
+    Position *p = ecs_get_ptr(world, e_1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get_ptr(world, e_2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    /* Entities can still be moved individually after the bulk move */
+    ecs_remove(world, e_2, Velocity);
+    test_assert(!ecs_has(world, e_2, Velocity));
+    test_assert(ecs_has(world, e_1, Velocity));
+
+    p = ecs_get_ptr(world, e_1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+static
+void AddVelocity(EcsRows *rows) {
+    ProbeSystem(rows);
+}
+
+void Add_w_filter_on_add() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, AddVelocity, EcsOnAdd, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    EcsEntity e = ecs_new_w_count(world, Position, 3, NULL);
+
+    ecs_add_w_filter(world, Velocity, Position);
+
+    /* OnAdd is invoked once for all entities in the table */
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e);
+    test_int(ctx.e[1], e + 1);
+    test_int(ctx.e[2], e + 2);
+    test_int(ctx.c[0][0], EVelocity);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,273 @@
+#include <include/api.h>
+
+static uint32_t ends[MAX_INVOCATIONS];
+static uint32_t padded_ends[MAX_INVOCATIONS];
+
+static
+void Dummy(EcsRows *rows) {
+    SysTestData *ctx = ecs_get_context(rows->world);
+    ends[ctx->invoked] = rows->end;
+    padded_ends[ctx->invoked] = rows->padded_end;
+    ProbeSystem(rows);
+}
+
+static
+void CheckAligned(EcsRows *rows) {
+    Position *p = ecs_column(rows, Position, 1);
+    test_assert(((uintptr_t)p % ECS_COLUMN_ALIGNMENT) == 0);
+    test_assert(((uintptr_t)rows->entities % ECS_COLUMN_ALIGNMENT) == 0);
+    ProbeSystem(rows);
+}
+
+static
+void IncrementPadded(EcsRows *rows) {
+    Position *p = ecs_column(rows, Position, 1);
+    test_assert((rows->begin % 8) == 0);
+    test_assert((rows->padded_end % 8) == 0);
+    test_assert(((uintptr_t)&p[rows->begin] % ECS_COLUMN_ALIGNMENT) == 0);
+
+    /* Write to padding rows too, like a vectorized loop would */
+    int i;
+    for (i = rows->begin; i < rows->padded_end; i ++) {
+        p[i].x ++;
+    }
+}
+
+static
+uint64_t group_by_component(
+    EcsWorld *world,
+    EcsType type,
+    EcsArray *entities,
+    void *ctx)
+{
+    EcsEntity component = *(EcsEntity*)ctx;
+    EcsEntity *buffer = ecs_array_buffer(entities);
+    uint32_t i, count = ecs_array_count(entities);
+
+    for (i = 0; i < count; i ++) {
+        if (buffer[i] == component) {
+            return 1;
+        }
+    }
+
+    return 2;
+}
+
+void Alignment_aligned_columns() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, CheckAligned, EcsOnFrame, Position);
+
+    ecs_set_simd_width(world, 8);
+
+    EcsEntity e = ecs_new_w_count(world, Position, 10, NULL);
+    test_assert(e != 0);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_new(world, Position);
+    }
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 110);
+
+    ecs_fini(world);
+}
+
+void Alignment_realign_existing_columns() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, CheckAligned, EcsOnFrame, Position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {1, 2});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {3, 4});
+
+    ecs_set_simd_width(world, 4);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 2);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_2);
+
+    test_int(ecs_get(world, e_1, Position).x, 1);
+    test_int(ecs_get(world, e_1, Position).y, 2);
+    test_int(ecs_get(world, e_2, Position).x, 3);
+    test_int(ecs_get(world, e_2, Position).y, 4);
+
+    ecs_fini(world);
+}
+
+void Alignment_padded_end() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Movable, Position, Velocity);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, Position);
+
+    ecs_set_simd_width(world, 8);
+
+    ecs_new_w_count(world, Position, 10, NULL);
+    ecs_new_w_count(world, Velocity, 16, NULL);
+    ecs_new_w_count(world, Position, 1, NULL);
+    ecs_new_w_count(world, Movable, 16, NULL);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 2);
+    test_int(ctx.count, 27);
+    test_int(ends[0], 11);
+    test_int(padded_ends[0], 16);
+    test_int(ends[1], 16);
+    test_int(padded_ends[1], 16);
+
+    ecs_fini(world);
+}
+
+void Alignment_padded_end_w_limit() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Dummy, EcsManual, Position);
+
+    ecs_set_simd_width(world, 8);
+
+    ecs_new_w_count(world, Position, 10, NULL);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    /* Rows after end belong to other entities, so end is not padded */
+    ecs_run_w_filter(world, Dummy, 1, 0, 5, 0, NULL);
+    test_int(ctx.invoked, 1);
+    test_int(ends[0], 5);
+    test_int(padded_ends[0], 5);
+
+    ecs_run_w_filter(world, Dummy, 1, 5, 5, 0, NULL);
+    test_int(ctx.invoked, 2);
+    test_int(ends[1], 10);
+    test_int(padded_ends[1], 16);
+
+    ecs_fini(world);
+}
+
+void Alignment_padded_end_wo_width() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, Position);
+
+    ecs_new_w_count(world, Position, 10, NULL);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ends[0], 10);
+    test_int(padded_ends[0], 10);
+
+    ecs_fini(world);
+}
+
+void Alignment_jobs_start_aligned() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Movable, Position, Velocity);
+
+    ECS_SYSTEM(world, IncrementPadded, EcsOnFrame, Position);
+
+    ecs_set_simd_width(world, 8);
+
+    EcsEntity e_1 = ecs_new_w_count(world, Position, 13, NULL);
+    EcsEntity e_2 = ecs_new_w_count(world, Movable, 50, NULL);
+
+    int i;
+    for (i = 0; i < 13; i ++) {
+        ecs_set(world, e_1 + i, Position, {0, 0});
+    }
+
+    for (i = 0; i < 50; i ++) {
+        ecs_set(world, e_2 + i, Position, {0, 0});
+    }
+
+    ecs_set_threads(world, 3);
+
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+
+    /* Every row is processed exactly once per frame */
+    for (i = 0; i < 13; i ++) {
+        test_int(ecs_get(world, e_1 + i, Position).x, 2);
+    }
+
+    for (i = 0; i < 50; i ++) {
+        test_int(ecs_get(world, e_2 + i, Position).x, 2);
+    }
+
+    ecs_fini(world);
+}
+
+void Alignment_jobs_start_aligned_w_group_by() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Movable, Position, Velocity);
+
+    ECS_SYSTEM(world, IncrementPadded, EcsOnFrame, Position);
+    ecs_set_group_by(world, IncrementPadded, group_by_component, &EVelocity);
+
+    ecs_set_simd_width(world, 8);
+
+    /* Tables are created in the opposite order of their groups */
+    EcsEntity e_1 = ecs_new_w_count(world, Position, 20, NULL);
+    EcsEntity e_2 = ecs_new_w_count(world, Movable, 6, NULL);
+
+    int i;
+    for (i = 0; i < 20; i ++) {
+        ecs_set(world, e_1 + i, Position, {0, 0});
+    }
+
+    for (i = 0; i < 6; i ++) {
+        ecs_set(world, e_2 + i, Position, {0, 0});
+    }
+
+    ecs_set_threads(world, 2);
+
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+
+    for (i = 0; i < 20; i ++) {
+        test_int(ecs_get(world, e_1 + i, Position).x, 2);
+    }
+
+    for (i = 0; i < 6; i ++) {
+        test_int(ecs_get(world, e_2 + i, Position).x, 2);
+    }
+
+    ecs_fini(world);
+}
@@ -155,3 +155,216 @@ void Delete_delete_3_of_3() {
     test_assert(ecs_empty(world, e2));
     test_assert(ecs_empty(world, e3));
 }
+
+void Delete_delete_recycle() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e1 = ecs_new(world, Position);
+    test_assert(e1 != 0);
+    test_assert(ecs_is_alive(world, e1));
+
+    ecs_delete(world, e1);
+    test_assert(!ecs_is_alive(world, e1));
+
+    EcsEntity e2 = ecs_new(world, Position);
+    test_assert(e2 != 0);
+    test_assert(e2 != e1);
+    test_assert((uint32_t)e2 == (uint32_t)e1);
+    test_assert(ecs_is_alive(world, e2));
+    test_assert(!ecs_is_alive(world, e1));
+    test_assert(ecs_has(world, e2, Position));
+    test_assert(!ecs_has(world, e1, Position));
+    test_assert(ecs_empty(world, e1));
+
+    ecs_fini(world);
+}
+
+void Delete_delete_empty_recycle() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity e1 = ecs_new(world, 0);
+    test_assert(e1 != 0);
+    test_assert(ecs_is_alive(world, e1));
+
+    ecs_delete(world, e1);
+    test_assert(!ecs_is_alive(world, e1));
+
+    EcsEntity e2 = ecs_new(world, 0);
+    test_assert(e2 != e1);
+    test_assert((uint32_t)e2 == (uint32_t)e1);
+    test_assert(ecs_is_alive(world, e2));
+
+    ecs_fini(world);
+}
+
+void Delete_delete_twice_recycle_once() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e1 = ecs_new(world, Position);
+    ecs_delete(world, e1);
+    ecs_delete(world, e1);
+
+    EcsEntity e2 = ecs_new(world, Position);
+    EcsEntity e3 = ecs_new(world, Position);
+    test_assert((uint32_t)e2 == (uint32_t)e1);
+    test_assert((uint32_t)e3 != (uint32_t)e1);
+
+    /* Deleting the stale handle must not delete the recycled entity */
+    ecs_delete(world, e1);
+    test_assert(ecs_is_alive(world, e2));
+    test_assert(ecs_has(world, e2, Position));
+
+    ecs_fini(world);
+}
+
+static
+void DeleteSelf(EcsRows *rows) {
+    int i;
+    for (i = rows->begin; i < rows->end; i ++) {
+        ecs_delete(rows->world, rows->entities[i]);
+    }
+}
+
+void Delete_delete_in_progress_recycle() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, DeleteSelf, EcsOnFrame, Position);
+
+    EcsEntity e1 = ecs_new(world, Position);
+    EcsEntity e2 = ecs_new(world, Position);
+
+    ecs_progress(world, 1);
+
+    test_assert(!ecs_is_alive(world, e1));
+    test_assert(!ecs_is_alive(world, e2));
+
+    ecs_enable(world, DeleteSelf, false);
+
+    EcsEntity e3 = ecs_new(world, Position);
+    EcsEntity e4 = ecs_new(world, Position);
+    test_assert((uint32_t)e3 == (uint32_t)e1 || (uint32_t)e3 == (uint32_t)e2);
+    test_assert((uint32_t)e4 == (uint32_t)e1 || (uint32_t)e4 == (uint32_t)e2);
+    test_assert(ecs_is_alive(world, e3));
+    test_assert(ecs_is_alive(world, e4));
+    test_assert(ecs_has(world, e3, Position));
+    test_assert(ecs_has(world, e4, Position));
+
+    ecs_fini(world);
+}
+
+void Delete_delete_w_filter() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    EcsEntity e1 = ecs_new(world, Position);
+    EcsEntity e2 = ecs_new(world, Type);
+    EcsEntity e3 = ecs_new(world, Velocity);
+    EcsEntity e4 = ecs_new(world, Position);
+
+    ecs_delete_w_filter(world, Position);
+
+    test_assert(!ecs_is_alive(world, e1));
+    test_assert(!ecs_is_alive(world, e2));
+    test_assert(!ecs_is_alive(world, e4));
+    test_assert(ecs_empty(world, e1));
+    test_assert(ecs_empty(world, e2));
+    test_assert(ecs_empty(world, e4));
+
+    test_assert(ecs_is_alive(world, e3));
+    test_assert(ecs_has(world, e3, Velocity));
+
+    /* Deleted ids are recycled */
+    EcsEntity e5 = ecs_new(world, Position);
+    test_assert((uint32_t)e5 == (uint32_t)e1 || (uint32_t)e5 == (uint32_t)e2 || 
+                (uint32_t)e5 == (uint32_t)e4);
+    test_assert(ecs_has(world, e5, Position));
+    test_assert(!ecs_has(world, e5, Velocity));
+
+    ecs_fini(world);
+}
+
+void Delete_delete_w_filter_2_components() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    EcsEntity e1 = ecs_new(world, Position);
+    EcsEntity e2 = ecs_new(world, Type);
+    EcsEntity e3 = ecs_new(world, Velocity);
+
+    ecs_delete_w_filter(world, Type);
+
+    test_assert(ecs_is_alive(world, e1));
+    test_assert(!ecs_is_alive(world, e2));
+    test_assert(ecs_is_alive(world, e3));
+    test_assert(ecs_has(world, e1, Position));
+    test_assert(ecs_has(world, e3, Velocity));
+
+    ecs_fini(world);
+}
+
+static
+void RemovePosition(EcsRows *rows) {
+    ProbeSystem(rows);
+}
+
+void Delete_delete_w_filter_on_remove() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, RemovePosition, EcsOnRemove, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    EcsEntity e = ecs_new_w_count(world, Position, 3, NULL);
+
+    ecs_delete_w_filter(world, Position);
+
+    /* OnRemove is invoked once for all entities in the table */
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e);
+    test_int(ctx.e[1], e + 1);
+    test_int(ctx.e[2], e + 2);
+    test_int(ctx.c[0][0], EPosition);
+
+    ecs_fini(world);
+}
+
+static
+void DeleteAll(EcsRows *rows) {
+    EcsType TPosition = ecs_column_type(rows, 3);
+    ecs_delete_w_filter(rows->world, Position);
+}
+
+void Delete_delete_w_filter_in_progress() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, DeleteAll, EcsOnFrame, Velocity, !Position, ID.Position);
+
+    EcsEntity e1 = ecs_new(world, Position);
+    EcsEntity e2 = ecs_new(world, Position);
+    EcsEntity e3 = ecs_new(world, Velocity);
+
+    ecs_progress(world, 1);
+
+    test_assert(!ecs_is_alive(world, e1));
+    test_assert(!ecs_is_alive(world, e2));
+    test_assert(ecs_is_alive(world, e3));
+    test_assert(ecs_has(world, e3, Velocity));
+
+    ecs_fini(world);
+}
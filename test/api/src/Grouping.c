@@ -0,0 +1,210 @@
+#include <include/api.h>
+
+static
+uint64_t group_by_container(
+    EcsWorld *world,
+    EcsType type,
+    EcsArray *entities,
+    void *ctx)
+{
+    EcsEntity *buffer = ecs_array_buffer(entities);
+    uint32_t i, count = ecs_array_count(entities);
+
+    for (i = 0; i < count; i ++) {
+        if (ecs_has(world, buffer[i], EcsContainer)) {
+            return buffer[i];
+        }
+    }
+
+    return 0;
+}
+
+static uint64_t groups[MAX_INVOCATIONS];
+
+static
+void Dummy(EcsRows *rows) {
+    SysTestData *ctx = ecs_get_context(rows->world);
+    groups[ctx->invoked] = rows->group;
+    ProbeSystem(rows);
+}
+
+static
+int compare_position(
+    EcsEntity e1,
+    void *ptr1,
+    EcsEntity e2,
+    void *ptr2)
+{
+    Position *p1 = ptr1;
+    Position *p2 = ptr2;
+    return (p1->x > p2->x) - (p1->x < p2->x);
+}
+
+void Grouping_group_by_container() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, Position);
+    ecs_set_group_by(world, Dummy, group_by_container, NULL);
+
+    EcsEntity parent_1 = ecs_new(world, 0);
+    EcsEntity parent_2 = ecs_new(world, 0);
+    EcsEntity e_1 = ecs_new_child(world, parent_2, NULL, Position);
+    EcsEntity e_2 = ecs_new(world, Position);
+    EcsEntity e_3 = ecs_new_child(world, parent_1, NULL, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 3);
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_3);
+    test_int(ctx.e[2], e_1);
+    test_int(groups[0], 0);
+    test_int(groups[1], parent_1);
+    test_int(groups[2], parent_2);
+
+    ecs_fini(world);
+}
+
+void Grouping_group_by_after_tables() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, Position);
+
+    EcsEntity parent_1 = ecs_new(world, 0);
+    EcsEntity parent_2 = ecs_new(world, 0);
+    EcsEntity e_1 = ecs_new_child(world, parent_2, NULL, Position);
+    EcsEntity e_2 = ecs_new_child(world, parent_1, NULL, Position);
+    EcsEntity e_3 = ecs_new_child(world, parent_2, NULL, Position);
+
+    ecs_set_group_by(world, Dummy, group_by_container, NULL);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 2);
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_1);
+    test_int(ctx.e[2], e_3);
+    test_int(groups[0], parent_1);
+    test_int(groups[1], parent_2);
+
+    ecs_fini(world);
+}
+
+void Grouping_group_after_reactivation() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, Position);
+    ecs_set_group_by(world, Dummy, group_by_container, NULL);
+
+    EcsEntity parent_1 = ecs_new(world, 0);
+    EcsEntity parent_2 = ecs_new(world, 0);
+    EcsEntity e_1 = ecs_new_child(world, parent_1, NULL, Position);
+    EcsEntity e_2 = ecs_new_child(world, parent_2, NULL, Position);
+    EcsEntity e_3 = ecs_new_child(world, parent_1, NULL, Position);
+    ecs_add(world, e_3, Velocity);
+
+    /* Deactivate and reactivate first table */
+    ecs_delete(world, e_1);
+    e_1 = ecs_new_child(world, parent_1, NULL, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 3);
+    test_int(ctx.count, 3);
+    test_int(groups[0], parent_1);
+    test_int(groups[1], parent_1);
+    test_int(groups[2], parent_2);
+    test_int(ctx.e[2], e_2);
+
+    ecs_fini(world);
+}
+
+void Grouping_group_w_order_by() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, [in] Position);
+    ecs_set_group_by(world, Dummy, group_by_container, NULL);
+    ecs_set_order_by(world, Dummy, Position, compare_position);
+
+    EcsEntity parent_1 = ecs_new(world, 0);
+    EcsEntity parent_2 = ecs_new(world, 0);
+    EcsEntity e_1 = ecs_new_child(world, parent_2, NULL, Position);
+    EcsEntity e_2 = ecs_new_child(world, parent_1, NULL, Position);
+    EcsEntity e_3 = ecs_new_child(world, parent_2, NULL, Position);
+    EcsEntity e_4 = ecs_new_child(world, parent_1, NULL, Position);
+    ecs_set(world, e_1, Position, {2, 0});
+    ecs_set(world, e_2, Position, {3, 0});
+    ecs_set(world, e_3, Position, {1, 0});
+    ecs_set(world, e_4, Position, {4, 0});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 2);
+    test_int(ctx.count, 4);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_4);
+    test_int(ctx.e[2], e_3);
+    test_int(ctx.e[3], e_1);
+
+    ecs_fini(world);
+}
+
+void Grouping_query_skip_group() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    EcsQuery *q = ecs_query_new(world, "Position");
+    ecs_query_group_by(world, q, group_by_container, NULL);
+
+    EcsEntity parent_1 = ecs_new(world, 0);
+    EcsEntity parent_2 = ecs_new(world, 0);
+    EcsEntity e_1 = ecs_new_child(world, parent_1, NULL, Position);
+    EcsEntity e_2 = ecs_new_child(world, parent_1, NULL, Position);
+    EcsEntity e_3 = ecs_new_child(world, parent_2, NULL, Position);
+    ecs_add(world, e_2, Velocity);
+
+    EcsQueryIter it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it) == true);
+    test_int(it.rows.group, parent_1);
+
+    /* Skip second table of parent_1 */
+    ecs_query_skip_group(&it);
+
+    test_assert(ecs_query_next(&it) == true);
+    test_int(it.rows.group, parent_2);
+    test_int(it.rows.count, 1);
+    test_int(it.rows.entities[0], e_3);
+
+    test_assert(ecs_query_next(&it) == false);
+
+    (void)e_1;
+
+    ecs_query_free(world, q);
+
+    ecs_fini(world);
+}
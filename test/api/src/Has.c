@@ -275,3 +275,53 @@ void Has_has_in_progress() {
     
     ecs_fini(world);
 }
+
+void Has_has_high_id() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    /* Entities with high ids are hashed in type signatures */
+    EcsEntity parents = ecs_new_w_count(world, 0, 1000, NULL);
+    EcsEntity parent_1 = parents + 500;
+    EcsEntity parent_2 = parents + 501;
+
+    EcsEntity child = ecs_new_child(world, parent_1, NULL, Position);
+    test_assert(ecs_contains(world, parent_1, child));
+    test_assert(!ecs_contains(world, parent_2, child));
+
+    EcsType TParent_1 = ecs_type_from_entity(world, parent_1);
+    EcsType TParent_2 = ecs_type_from_entity(world, parent_2);
+    EcsType TType = ecs_merge_type(world, Parent_1, Position, 0);
+
+    test_assert(ecs_has(world, child, Parent_1));
+    test_assert(!ecs_has(world, child, Parent_2));
+    test_assert(ecs_has(world, child, Type));
+
+    ecs_fini(world);
+}
+
+void Has_any_of_high_id() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    EcsEntity parents = ecs_new_w_count(world, 0, 1000, NULL);
+    EcsEntity parent_1 = parents + 500;
+    EcsEntity parent_2 = parents + 501;
+
+    EcsEntity child = ecs_new_child(world, parent_1, NULL, Position);
+
+    EcsType TParent_1 = ecs_type_from_entity(world, parent_1);
+    EcsType TParent_2 = ecs_type_from_entity(world, parent_2);
+    EcsType TType_1 = ecs_merge_type(world, Parent_1, Velocity, 0);
+    EcsType TType_2 = ecs_merge_type(world, Parent_2, Velocity, 0);
+    EcsType TType_3 = ecs_merge_type(world, Parent_2, Position, 0);
+
+    test_assert(ecs_has_any(world, child, Type_1));
+    test_assert(!ecs_has_any(world, child, Type_2));
+    test_assert(ecs_has_any(world, child, Type_3));
+
+    ecs_fini(world);
+}
@@ -131,3 +131,215 @@ void Internals_activate_deactivate_activate_other() {
 
     ecs_fini(world);
 }
+
+static
+void Probe(EcsRows *rows) {
+    ProbeSystem(rows);
+}
+
+void Internals_deferred_activate_table() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Probe, EcsOnFrame, Position);
+
+    ecs_set_deferred_activation(world, true);
+
+    ECS_ENTITY(world, e_1, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_1);
+
+    ecs_fini(world);
+}
+
+void Internals_deferred_deactivate_table() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Probe, EcsOnFrame, Position);
+
+    ecs_set_deferred_activation(world, true);
+
+    ECS_ENTITY(world, e_1, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 1);
+
+    ecs_delete(world, e_1);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    ecs_fini(world);
+}
+
+void Internals_deferred_empty_and_fill_table() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Probe, EcsOnFrame, Position);
+
+    ecs_set_deferred_activation(world, true);
+
+    ECS_ENTITY(world, e_1, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 1);
+
+    /* Table is emptied and filled within the same frame */
+    ecs_delete(world, e_1);
+    EcsEntity e_2 = ecs_new(world, Position);
+    test_assert(e_2 != 0);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_2);
+
+    ecs_fini(world);
+}
+
+void Internals_deferred_deactivation_delay() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Probe, EcsOnFrame, Position);
+
+    ecs_set_deferred_activation(world, true);
+    ecs_set_deactivation_delay(world, 2);
+
+    ECS_ENTITY(world, e_1, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 1);
+
+    ecs_delete(world, e_1);
+
+    /* Table stays active for two frames, but is not iterated */
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    EcsEntity e_2 = ecs_new(world, Position);
+    test_assert(e_2 != 0);
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_2);
+
+    /* Leaving deferred mode applies the pending deactivation */
+    ecs_delete(world, e_2);
+    ecs_set_deferred_activation(world, false);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    EcsEntity e_3 = ecs_new(world, Position);
+    test_assert(e_3 != 0);
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_3);
+
+    ecs_fini(world);
+}
+
+void Internals_deferred_deactivate_table_w_threads() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Probe, EcsOnFrame, Position);
+
+    ecs_set_deferred_activation(world, true);
+    ecs_set_deactivation_delay(world, 1);
+    ecs_set_threads(world, 2);
+
+    EcsEntity e_1 = ecs_new_w_count(world, Position, 10, NULL);
+    test_assert(e_1 != 0);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 10);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_delete(world, e_1 + i);
+    }
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    ecs_fini(world);
+}
+
+static
+void AddVelocity(EcsRows *rows) {
+    EcsType TVelocity = ecs_column_type(rows, 2);
+
+    int i;
+    for (i = rows->begin; i < rows->end; i ++) {
+        ecs_add(rows->world, rows->entities[i], Velocity);
+    }
+}
+
+void Internals_add_from_worker_threads() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, AddVelocity, EcsOnFrame, Position, ID.Velocity);
+
+    ecs_set_threads(world, 8);
+
+    /* Enough entities for the workers to add to their stages concurrently */
+    EcsEntity e_1 = ecs_new_w_count(world, Position, 100000, NULL);
+    test_assert(e_1 != 0);
+
+    ecs_progress(world, 1);
+
+    /* Each worker adds to its own stage, which is merged after the frame */
+    int i;
+    for (i = 0; i < 100000; i ++) {
+        test_assert(ecs_has(world, e_1 + i, Position));
+        test_assert(ecs_has(world, e_1 + i, Velocity));
+    }
+
+    ecs_fini(world);
+}
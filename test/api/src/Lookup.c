@@ -0,0 +1,143 @@
+#include <include/api.h>
+
+void Lookup_lookup() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity e = ecs_set(world, 0, EcsId, {"foo"});
+    test_assert(e != 0);
+
+    test_assert(ecs_lookup(world, "foo") == e);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_component() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    test_assert(ecs_lookup(world, "Position") == EPosition);
+    test_assert(ecs_lookup(world, "EcsComponent") == EEcsComponent);
+
+    ecs_fini(world);
+}
+
+static
+void Dummy(EcsRows *rows) { }
+
+void Lookup_lookup_system() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, Position);
+
+    test_assert(ecs_lookup(world, "Dummy") == Dummy);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_not_found() {
+    EcsWorld *world = ecs_init();
+
+    ecs_set(world, 0, EcsId, {"foo"});
+
+    test_assert(ecs_lookup(world, "bar") == 0);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_after_delete() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity e = ecs_set(world, 0, EcsId, {"foo"});
+    test_assert(ecs_lookup(world, "foo") == e);
+
+    ecs_delete(world, e);
+    test_assert(ecs_lookup(world, "foo") == 0);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_after_remove_id() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity e = ecs_set(world, 0, EcsId, {"foo"});
+    test_assert(ecs_lookup(world, "foo") == e);
+
+    ecs_remove(world, e, EcsId);
+    test_assert(ecs_lookup(world, "foo") == 0);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_after_rename() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity e = ecs_set(world, 0, EcsId, {"foo"});
+    ecs_set(world, e, EcsId, {"bar"});
+
+    test_assert(ecs_lookup(world, "foo") == 0);
+    test_assert(ecs_lookup(world, "bar") == e);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_child() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity parent_1 = ecs_new(world, 0);
+    EcsEntity parent_2 = ecs_new(world, 0);
+    EcsEntity child_1 = ecs_new_child(world, parent_1, "foo", 0);
+    EcsEntity child_2 = ecs_new_child(world, parent_2, "foo", 0);
+
+    test_assert(ecs_lookup_child(world, parent_1, "foo") == child_1);
+    test_assert(ecs_lookup_child(world, parent_2, "foo") == child_2);
+    test_assert(ecs_lookup_child(world, parent_1, "bar") == 0);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_path() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity parent = ecs_set(world, 0, EcsId, {"parent"});
+    EcsEntity child = ecs_new_child(world, parent, "child", 0);
+    EcsEntity grandchild = ecs_new_child(world, child, "grandchild", 0);
+    ecs_new_child(world, 0, "child", 0);
+
+    test_assert(ecs_lookup_path(world, "parent") == parent);
+    test_assert(ecs_lookup_path(world, "parent.child") == child);
+    test_assert(ecs_lookup_path(world, "parent.child.grandchild") == grandchild);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_path_not_found() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity parent = ecs_set(world, 0, EcsId, {"parent"});
+    ecs_new_child(world, parent, "child", 0);
+    ecs_new_child(world, 0, "other", 0);
+
+    test_assert(ecs_lookup_path(world, "parent.other") == 0);
+    test_assert(ecs_lookup_path(world, "other.child") == 0);
+    test_assert(ecs_lookup_path(world, "foo.child") == 0);
+
+    ecs_fini(world);
+}
+
+void Lookup_lookup_after_clone() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity e = ecs_set(world, 0, EcsId, {"foo"});
+    test_assert(e != 0);
+
+    EcsEntity clone = ecs_clone(world, e, true);
+    test_assert(clone != 0);
+
+    ecs_delete(world, e);
+
+    test_assert(ecs_lookup(world, "foo") == clone);
+
+    ecs_fini(world);
+}
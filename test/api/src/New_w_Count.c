@@ -239,3 +239,158 @@ void New_w_Count_type_w_tag_mixed() {
 
     ecs_fini(world);
 }
+
+void New_w_Count_new_w_count_delete() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e = ecs_new_w_count(world, Position, 10000, NULL);
+    test_assert(e != 0);
+
+    int i;
+    for (i = 0; i < 10000; i += 2) {
+        ecs_delete(world, e + i);
+    }
+
+    for (i = 0; i < 10000; i ++) {
+        if (i % 2) {
+            test_assert(ecs_has(world, e + i, Position));
+        } else {
+            test_assert(ecs_empty(world, e + i));
+        }
+    }
+
+    ecs_fini(world);
+}
+
+void New_w_Count_new_w_data() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    Position p[3] = {{10, 20}, {30, 40}, {50, 60}};
+    Velocity v[3] = {{1, 2}, {3, 4}, {5, 6}};
+    void *data[] = {p, v};
+    EcsEntity handles[3];
+
+    EcsEntity e = ecs_new_w_data(world, Type, 3, data, handles);
+    test_assert(e != 0);
+
+    int i;
+    for (i = 0; i < 3; i ++) {
+        test_int(handles[i], e + i);
+
+        Position *ptr_p = ecs_get_ptr(world, e + i, Position);
+        test_assert(ptr_p != NULL);
+        test_int(ptr_p->x, p[i].x);
+        test_int(ptr_p->y, p[i].y);
+
+        Velocity *ptr_v = ecs_get_ptr(world, e + i, Velocity);
+        test_assert(ptr_v != NULL);
+        test_int(ptr_v->x, v[i].x);
+        test_int(ptr_v->y, v[i].y);
+    }
+
+    ecs_fini(world);
+}
+
+void New_w_Count_new_w_data_null_buffer() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    Velocity v[2] = {{1, 2}, {3, 4}};
+    void *data[] = {NULL, v};
+
+    EcsEntity e = ecs_new_w_data(world, Type, 2, data, NULL);
+    test_assert(e != 0);
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        test_assert(ecs_has(world, e + i, Position));
+
+        Velocity *ptr_v = ecs_get_ptr(world, e + i, Velocity);
+        test_assert(ptr_v != NULL);
+        test_int(ptr_v->x, v[i].x);
+        test_int(ptr_v->y, v[i].y);
+    }
+
+    ecs_fini(world);
+}
+
+static
+void SetPosition(EcsRows *rows) {
+    ProbeSystem(rows);
+}
+
+void New_w_Count_new_w_data_on_set() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+    ECS_SYSTEM(world, SetPosition, EcsOnSet, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    Position p[3] = {{10, 20}, {30, 40}, {50, 60}};
+    void *data[] = {p, NULL};
+
+    EcsEntity e = ecs_new_w_data(world, Type, 3, data, NULL);
+
+    /* OnSet is invoked once for all new entities */
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e);
+    test_int(ctx.e[1], e + 1);
+    test_int(ctx.e[2], e + 2);
+    test_int(ctx.c[0][0], EPosition);
+
+    ecs_fini(world);
+}
+
+static
+void NewWithData(EcsRows *rows) {
+    EcsType TPosition = ecs_column_type(rows, 2);
+
+    Position p[2] = {{10, 20}, {30, 40}};
+    void *data[] = {p};
+    EcsEntity *handles = ecs_get_context(rows->world);
+
+    ecs_new_w_data(rows->world, Position, 2, data, handles);
+}
+
+void New_w_Count_new_w_data_in_progress() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, NewWithData, EcsOnFrame, Velocity, ID.Position);
+
+    EcsEntity handles[2] = {0};
+    ecs_set_context(world, handles);
+
+    ecs_new(world, Velocity);
+    ecs_progress(world, 1);
+
+    test_assert(handles[0] != 0);
+    test_assert(handles[1] != 0);
+
+    Position *p = ecs_get_ptr(world, handles[0], Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get_ptr(world, handles[1], Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
@@ -947,3 +947,122 @@ void Prefab_new_w_count_w_override() {
 
     ecs_fini(world);
 }
+
+void Prefab_get_ptr_from_nested_prefab() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_PREFAB(world, Base, Position, Mass);
+    ECS_PREFAB(world, Mid, Base, Velocity);
+    ECS_PREFAB(world, Top, Mid);
+
+    ecs_set(world, Base, Position, {10, 20});
+    ecs_set(world, Base, Mass, {50});
+    ecs_set(world, Mid, Velocity, {30, 40});
+
+    EcsEntity e = ecs_new(world, Top);
+    test_assert(e != 0);
+    test_assert( ecs_has(world, e, Position));
+    test_assert( ecs_has(world, e, Velocity));
+    test_assert( ecs_has(world, e, Mass));
+
+    Position *p = ecs_get_ptr(world, e, Position);
+    test_assert(p != NULL);
+    test_assert(p == ecs_get_ptr(world, Base, Position));
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    Velocity *v = ecs_get_ptr(world, e, Velocity);
+    test_assert(v != NULL);
+    test_assert(v == ecs_get_ptr(world, Mid, Velocity));
+    test_int(v->x, 30);
+    test_int(v->y, 40);
+
+    Mass *m = ecs_get_ptr(world, e, Mass);
+    test_assert(m != NULL);
+    test_assert(m == ecs_get_ptr(world, Base, Mass));
+    test_int(*m, 50);
+
+    ecs_fini(world);
+}
+
+void Prefab_override_from_nearest_prefab() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Mass);
+    ECS_PREFAB(world, Base, Position, Mass);
+    ECS_PREFAB(world, Mid, Base, Position);
+    ECS_TYPE(world, Type, Mid, Position, Mass);
+
+    ecs_set(world, Base, Position, {10, 20});
+    ecs_set(world, Base, Mass, {50});
+    ecs_set(world, Mid, Position, {30, 40});
+
+    EcsEntity e = ecs_new(world, Mid);
+    Position *p = ecs_get_ptr(world, e, Position);
+    test_assert(p == ecs_get_ptr(world, Mid, Position));
+
+    ecs_add(world, e, Position);
+    ecs_add(world, e, Mass);
+
+    p = ecs_get_ptr(world, e, Position);
+    test_assert(p != NULL);
+    test_assert(p != ecs_get_ptr(world, Mid, Position));
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    Mass *m = ecs_get_ptr(world, e, Mass);
+    test_assert(m != NULL);
+    test_assert(m != ecs_get_ptr(world, Base, Mass));
+    test_int(*m, 50);
+
+    EcsEntity e_1 = ecs_new_w_count(world, Type, 10, NULL);
+    EcsEntity i;
+    for (i = e_1; i < e_1 + 10; i ++) {
+        p = ecs_get_ptr(world, i, Position);
+        test_assert(p != NULL);
+        test_int(p->x, 30);
+        test_int(p->y, 40);
+
+        m = ecs_get_ptr(world, i, Mass);
+        test_assert(m != NULL);
+        test_int(*m, 50);
+    }
+
+    ecs_fini(world);
+}
+
+void Prefab_change_type_of_nested_prefab() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_PREFAB(world, Base, Position);
+    ECS_PREFAB(world, Mid, Base);
+
+    ecs_set(world, Base, Position, {10, 20});
+
+    EcsEntity e = ecs_new(world, Mid);
+    Position *p = ecs_get_ptr(world, e, Position);
+    test_assert(p == ecs_get_ptr(world, Base, Position));
+
+    ecs_set(world, Mid, Position, {30, 40});
+    p = ecs_get_ptr(world, e, Position);
+    test_assert(p == ecs_get_ptr(world, Mid, Position));
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_remove(world, Mid, Position);
+    p = ecs_get_ptr(world, e, Position);
+    test_assert(p == ecs_get_ptr(world, Base, Position));
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_remove(world, Base, Position);
+    test_assert(ecs_get_ptr(world, e, Position) == NULL);
+    test_assert(!ecs_has(world, e, Position));
+
+    ecs_fini(world);
+}
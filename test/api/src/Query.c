@@ -0,0 +1,250 @@
+#include <include/api.h>
+
+void Query_query_1_table() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {1, 2});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {3, 4});
+
+    EcsQuery *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    EcsQueryIter it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it) == true);
+    test_int(it.rows.count, 2);
+    test_int(it.rows.begin, 0);
+    test_int(it.rows.end, 2);
+    test_int(it.rows.column_count, 1);
+    test_int(it.rows.entities[0], e_1);
+    test_int(it.rows.entities[1], e_2);
+
+    Position *p = ecs_column(&it.rows, Position, 1);
+    test_int(p[0].x, 1);
+    test_int(p[0].y, 2);
+    test_int(p[1].x, 3);
+    test_int(p[1].y, 4);
+
+    p[0].x = 10;
+
+    test_assert(ecs_query_next(&it) == false);
+
+    test_int(ecs_get(world, e_1, Position).x, 10);
+
+    ecs_query_free(world, q);
+
+    ecs_fini(world);
+}
+
+void Query_query_2_tables() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+    ECS_ENTITY(world, e_3, Velocity);
+
+    EcsQuery *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    EcsEntity found[2];
+    uint32_t count = 0;
+
+    EcsQueryIter it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        test_int(it.rows.count, 1);
+        test_int(it.rows.index_offset, count);
+        test_assert(ecs_column(&it.rows, Position, 1) != NULL);
+        found[count ++] = it.rows.entities[0];
+    }
+
+    test_int(count, 2);
+    test_assert(found[0] == e_1 || found[1] == e_1);
+    test_assert(found[0] == e_2 || found[1] == e_2);
+
+    ecs_query_free(world, q);
+
+    ecs_fini(world);
+}
+
+void Query_query_table_created_after_query() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    EcsQuery *q = ecs_query_new(world, "Position, Velocity");
+    test_assert(q != NULL);
+
+    EcsQueryIter it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it) == false);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+
+    it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it) == true);
+    test_int(it.rows.count, 1);
+    test_int(it.rows.entities[0], e_2);
+    test_assert(ecs_column(&it.rows, Velocity, 2) != NULL);
+    test_assert(ecs_query_next(&it) == false);
+
+    ecs_query_free(world, q);
+
+    ecs_fini(world);
+}
+
+void Query_query_skip_empty_table() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+
+    EcsQuery *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    ecs_delete(world, e_1);
+
+    EcsQueryIter it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it) == true);
+    test_int(it.rows.count, 1);
+    test_int(it.rows.entities[0], e_2);
+    test_assert(ecs_query_next(&it) == false);
+
+    ecs_query_free(world, q);
+
+    ecs_fini(world);
+}
+
+void Query_query_w_not() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+
+    EcsQuery *q = ecs_query_new(world, "Position, !Velocity");
+    test_assert(q != NULL);
+
+    EcsQueryIter it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it) == true);
+    test_int(it.rows.count, 1);
+    test_int(it.rows.entities[0], e_1);
+    test_assert(ecs_query_next(&it) == false);
+
+    ecs_query_free(world, q);
+
+    ecs_fini(world);
+}
+
+void Query_query_w_shared() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_PREFAB(world, Prefab, Velocity);
+
+    ecs_set(world, Prefab, Velocity, {1, 2});
+
+    EcsEntity e_1 = ecs_new(world, Prefab);
+    ecs_set(world, e_1, Position, {10, 20});
+
+    EcsQuery *q = ecs_query_new(world, "Position, Velocity");
+    test_assert(q != NULL);
+
+    EcsQueryIter it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it) == true);
+    test_int(it.rows.count, 1);
+    test_int(it.rows.entities[0], e_1);
+
+    Velocity *v = ecs_shared(&it.rows, Velocity, 2);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+    test_int(ecs_column_source(&it.rows, 2), Prefab);
+
+    test_assert(ecs_query_next(&it) == false);
+
+    ecs_query_free(world, q);
+
+    ecs_fini(world);
+}
+
+static EcsQuery *sys_query;
+
+static
+void IterQuery(EcsRows *rows) {
+    SysTestData *ctx = ecs_get_context(rows->world);
+
+    EcsQueryIter it = ecs_query_iter(rows->world, sys_query);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_column(&it.rows, Position, 1);
+        int i;
+        for (i = it.rows.begin; i < it.rows.end; i ++) {
+            p[i].x ++;
+            ctx->count ++;
+        }
+    }
+
+    ctx->invoked ++;
+}
+
+void Query_query_in_system() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, IterQuery, EcsOnFrame, Velocity);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+
+    sys_query = ecs_query_new(world, "Position");
+    test_assert(sys_query != NULL);
+
+    ecs_set(world, e_1, Position, {10, 20});
+    ecs_set(world, e_2, Position, {30, 40});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 2);
+    test_int(ecs_get(world, e_1, Position).x, 11);
+    test_int(ecs_get(world, e_2, Position).x, 31);
+
+    ecs_query_free(world, sys_query);
+
+    ecs_fini(world);
+}
+
+void Query_query_free_on_fini() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_ENTITY(world, e_1, Position);
+
+    EcsQuery *q_1 = ecs_query_new(world, "Position");
+    EcsQuery *q_2 = ecs_query_new(world, "Velocity");
+    EcsQuery *q_3 = ecs_query_new(world, "Position, Velocity");
+    test_assert(q_1 != NULL);
+    test_assert(q_2 != NULL);
+    test_assert(q_3 != NULL);
+
+    ecs_query_free(world, q_2);
+
+    ecs_fini(world);
+}
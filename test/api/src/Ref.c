@@ -0,0 +1,224 @@
+#include <include/api.h>
+
+void Ref_get_ref() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e = ecs_set(world, 0, Position, {10, 20});
+
+    EcsRef ref = {0};
+    Position *p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p != NULL);
+    test_assert(p == ecs_get_ptr(world, e, Position));
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p == ecs_get_ptr(world, e, Position));
+
+    ecs_fini(world);
+}
+
+void Ref_get_ref_after_add() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    EcsEntity e = ecs_set(world, 0, Position, {10, 20});
+
+    EcsRef ref = {0};
+    Position *p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p != NULL);
+
+    /* Entity moves to another table */
+    ecs_add(world, e, Velocity);
+
+    p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p != NULL);
+    test_assert(p == ecs_get_ptr(world, e, Position));
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void Ref_get_ref_after_realloc() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e = ecs_set(world, 0, Position, {10, 20});
+
+    EcsRef ref = {0};
+    Position *p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p != NULL);
+
+    /* Grow table so that columns are reallocated */
+    ecs_new_w_count(world, Position, 1000, NULL);
+
+    p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p != NULL);
+    test_assert(p == ecs_get_ptr(world, e, Position));
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void Ref_get_ref_after_many_inserts() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e = ecs_set(world, 0, Position, {10, 20});
+
+    EcsRef ref = {0};
+    Position *p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p != NULL);
+
+    /* A component column may be reallocated while the entity column is grown
+     * in place, so check the reference after every insert */
+    int i;
+    for (i = 0; i < 5000; i ++) {
+        ecs_new(world, Position);
+
+        p = ecs_get_ref(world, &ref, e, Position);
+        test_assert(p == ecs_get_ptr(world, e, Position));
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+    }
+
+    ecs_fini(world);
+}
+
+void Ref_get_ref_after_delete_other() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {10, 20});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {30, 40});
+
+    EcsRef ref = {0};
+    Position *p = ecs_get_ref(world, &ref, e_2, Position);
+    test_assert(p != NULL);
+
+    /* Last entity is moved to the row of the deleted entity */
+    ecs_delete(world, e_1);
+
+    p = ecs_get_ref(world, &ref, e_2, Position);
+    test_assert(p != NULL);
+    test_assert(p == ecs_get_ptr(world, e_2, Position));
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void Ref_get_ref_after_remove() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    EcsEntity e = ecs_new(world, Type);
+
+    EcsRef ref = {0};
+    test_assert(ecs_get_ref(world, &ref, e, Position) != NULL);
+
+    ecs_remove(world, e, Position);
+
+    test_assert(ecs_get_ref(world, &ref, e, Position) == NULL);
+
+    ecs_fini(world);
+}
+
+void Ref_get_ref_other_entity() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {10, 20});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {30, 40});
+
+    EcsRef ref = {0};
+    Position *p = ecs_get_ref(world, &ref, e_1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+
+    p = ecs_get_ref(world, &ref, e_2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+
+    ecs_fini(world);
+}
+
+void Ref_get_ref_from_prefab() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_PREFAB(world, Prefab, Velocity);
+
+    ecs_set(world, Prefab, Velocity, {10, 20});
+
+    EcsEntity e = ecs_new(world, Prefab);
+
+    EcsRef ref = {0};
+    Velocity *v = ecs_get_ref(world, &ref, e, Velocity);
+    test_assert(v != NULL);
+    test_assert(v == ecs_get_ptr(world, Prefab, Velocity));
+
+    /* Override component of prefab */
+    ecs_set(world, e, Velocity, {30, 40});
+
+    v = ecs_get_ref(world, &ref, e, Velocity);
+    test_assert(v != NULL);
+    test_assert(v != ecs_get_ptr(world, Prefab, Velocity));
+    test_int(v->x, 30);
+    test_int(v->y, 40);
+
+    ecs_fini(world);
+}
+
+static
+void GetRef(EcsRows *rows) {
+    EcsType TPosition = ecs_column_type(rows, 2);
+    EcsRef *ref = ecs_get_context(rows->world);
+    EcsEntity e = ref->entity;
+
+    ecs_set(rows->world, e, Position, {30, 40});
+
+    Position *p = ecs_get_ref(rows->world, ref, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+}
+
+void Ref_get_ref_in_progress() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, GetRef, EcsOnFrame, Velocity, ID.Position);
+
+    EcsEntity e = ecs_set(world, 0, Position, {10, 20});
+    ecs_new(world, Velocity);
+
+    EcsRef ref = {0};
+    Position *p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p != NULL);
+
+    ecs_set_context(world, &ref);
+    ecs_progress(world, 1);
+
+    p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
@@ -261,3 +261,119 @@ void Remove_not_added() {
 
     ecs_fini(world);
 }
+
+void Remove_w_filter() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    EcsEntity e_1 = ecs_new(world, Type);
+    ecs_set(world, e_1, Position, {10, 20});
+    EcsEntity e_2 = ecs_new(world, Type);
+    ecs_set(world, e_2, Position, {30, 40});
+    EcsEntity e_3 = ecs_new(world, Velocity);
+
+    ecs_remove_w_filter(world, Velocity, Position);
+
+    test_assert(!ecs_has(world, e_1, Velocity));
+    test_assert(!ecs_has(world, e_2, Velocity));
+    test_assert(ecs_has(world, e_3, Velocity));
+
+    Position *p = ecs_get_ptr(world, e_1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get_ptr(world, e_2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void Remove_w_filter_all() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    EcsEntity e = ecs_new_w_count(world, Position, 3, NULL);
+
+    ecs_remove_w_filter(world, Position, Position);
+
+    /* Entities no longer have components, but are not deleted */
+    test_assert(ecs_empty(world, e));
+    test_assert(ecs_empty(world, e + 1));
+    test_assert(ecs_empty(world, e + 2));
+    test_assert(ecs_is_alive(world, e));
+    test_assert(ecs_is_alive(world, e + 2));
+
+    ecs_add(world, e + 1, Position);
+    test_assert(ecs_has(world, e + 1, Position));
+    test_assert(!ecs_has(world, e, Position));
+
+    ecs_fini(world);
+}
+
+static
+void RemoveVelocity(EcsRows *rows) {
+    ProbeSystem(rows);
+}
+
+void Remove_w_filter_on_remove() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+    ECS_SYSTEM(world, RemoveVelocity, EcsOnRemove, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    EcsEntity e = ecs_new_w_count(world, Type, 3, NULL);
+
+    ecs_remove_w_filter(world, Velocity, Position);
+
+    /* OnRemove is invoked once for all entities in the table */
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e);
+    test_int(ctx.e[1], e + 1);
+    test_int(ctx.e[2], e + 2);
+    test_int(ctx.c[0][0], EVelocity);
+
+    test_assert(!ecs_has(world, e, Velocity));
+    test_assert(ecs_has(world, e, Position));
+
+    ecs_fini(world);
+}
+
+static
+void RemoveAll(EcsRows *rows) {
+    EcsType TVelocity = ecs_column_type(rows, 2);
+    ecs_remove_w_filter(rows->world, Velocity, Velocity);
+}
+
+void Remove_w_filter_in_progress() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+    ECS_SYSTEM(world, RemoveAll, EcsOnFrame, Position, ID.Velocity);
+
+    EcsEntity e_1 = ecs_new(world, Type);
+    EcsEntity e_2 = ecs_new(world, Type);
+
+    ecs_progress(world, 1);
+
+    test_assert(!ecs_has(world, e_1, Velocity));
+    test_assert(!ecs_has(world, e_2, Velocity));
+    test_assert(ecs_has(world, e_1, Position));
+    test_assert(ecs_has(world, e_2, Position));
+
+    ecs_fini(world);
+}
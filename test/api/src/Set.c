@@ -302,3 +302,28 @@ void Set_set_and_new() {
 
     ecs_fini(world);
 }
+
+void Set_set_many_components() {
+    EcsWorld *world = ecs_init();
+
+    EcsEntity components[40];
+    char names[40][16];
+    EcsEntity e = ecs_new(world, 0);
+
+    int i;
+    for (i = 0; i < 40; i ++) {
+        sprintf(names[i], "Comp%d", i);
+        components[i] = ecs_new_component(world, names[i], sizeof(int));
+        EcsType type = ecs_type_from_entity(world, components[i]);
+        _ecs_set_ptr(world, e, type, sizeof(int), &i);
+    }
+
+    for (i = 0; i < 40; i ++) {
+        EcsType type = ecs_type_from_entity(world, components[i]);
+        int *ptr = _ecs_get_ptr(world, e, type);
+        test_assert(ptr != NULL);
+        test_int(*ptr, i);
+    }
+
+    ecs_fini(world);
+}
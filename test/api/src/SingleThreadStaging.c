@@ -2421,9 +2421,10 @@ void SingleThreadStaging_match_table_created_in_progress() {
     test_int(ctx.column_count, 2);
     test_null(ctx.param);
 
-    test_int(ctx.e[0], e_2);
-    test_int(ctx.e[1], e_3);
-    test_int(ctx.e[2], e_1);
+    /* Order in which staged entities are merged is not defined */
+    test_assert(ctx.e[0] == e_1 || ctx.e[1] == e_1 || ctx.e[2] == e_1);
+    test_assert(ctx.e[0] == e_2 || ctx.e[1] == e_2 || ctx.e[2] == e_2);
+    test_assert(ctx.e[0] == e_3 || ctx.e[1] == e_3 || ctx.e[2] == e_3);
     test_int(ctx.c[0][0], EPosition);
     test_int(ctx.s[0][0], 0);
     test_int(ctx.c[0][1], EVelocity);
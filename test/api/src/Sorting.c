@@ -0,0 +1,260 @@
+#include <include/api.h>
+
+static
+int compare_position(
+    EcsEntity e1,
+    void *ptr1,
+    EcsEntity e2,
+    void *ptr2)
+{
+    Position *p1 = ptr1;
+    Position *p2 = ptr2;
+    return (p1->x > p2->x) - (p1->x < p2->x);
+}
+
+static
+void Dummy(EcsRows *rows) {
+    ProbeSystem(rows);
+}
+
+void Sorting_sort_1_table() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, [in] Position);
+    ecs_set_order_by(world, Dummy, Position, compare_position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {3, 0});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {1, 0});
+    EcsEntity e_3 = ecs_set(world, 0, Position, {4, 0});
+    EcsEntity e_4 = ecs_set(world, 0, Position, {2, 0});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 4);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_4);
+    test_int(ctx.e[2], e_1);
+    test_int(ctx.e[3], e_3);
+
+    /* Rows are moved, so components must still be found for the entities */
+    test_int(ecs_get(world, e_1, Position).x, 3);
+    test_int(ecs_get(world, e_2, Position).x, 1);
+    test_int(ecs_get(world, e_3, Position).x, 4);
+    test_int(ecs_get(world, e_4, Position).x, 2);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_2_tables() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, [in] Position);
+    ecs_set_order_by(world, Dummy, Position, compare_position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {5, 0});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {1, 0});
+    EcsEntity e_3 = ecs_set(world, 0, Position, {2, 0});
+    EcsEntity e_4 = ecs_set(world, 0, Position, {4, 0});
+    EcsEntity e_5 = ecs_set(world, 0, Position, {3, 0});
+    ecs_add(world, e_4, Velocity);
+    ecs_add(world, e_5, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    /* e_2, e_3 | e_5, e_4 | e_1 */
+    test_int(ctx.invoked, 3);
+    test_int(ctx.count, 5);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_3);
+    test_int(ctx.e[2], e_5);
+    test_int(ctx.e[3], e_4);
+    test_int(ctx.e[4], e_1);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_after_set() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, [in] Position);
+    ecs_set_order_by(world, Dummy, Position, compare_position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {1, 0});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {2, 0});
+    EcsEntity e_3 = ecs_set(world, 0, Position, {3, 0});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_2);
+    test_int(ctx.e[2], e_3);
+
+    ecs_set(world, e_1, Position, {4, 0});
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_3);
+    test_int(ctx.e[2], e_1);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_after_new() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, [in] Position);
+    ecs_set_order_by(world, Dummy, Position, compare_position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {2, 0});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {4, 0});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_2);
+
+    EcsEntity e_3 = ecs_set(world, 0, Position, {3, 0});
+    EcsEntity e_4 = ecs_set(world, 0, Position, {1, 0});
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 4);
+    test_int(ctx.e[0], e_4);
+    test_int(ctx.e[1], e_1);
+    test_int(ctx.e[2], e_3);
+    test_int(ctx.e[3], e_2);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_shared() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_PREFAB(world, Prefab, Position);
+
+    ecs_set(world, Prefab, Position, {2, 0});
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, [in] Position, Velocity);
+    ecs_set_order_by(world, Dummy, Position, compare_position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {3, 0});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {1, 0});
+    EcsEntity e_3 = ecs_new(world, Prefab);
+    ecs_add(world, e_1, Velocity);
+    ecs_add(world, e_2, Velocity);
+    ecs_add(world, e_3, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 3);
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_3);
+    test_int(ctx.e[2], e_1);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_remove_order() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Dummy, EcsOnFrame, [in] Position);
+    ecs_set_order_by(world, Dummy, Position, compare_position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {2, 0});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {1, 0});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_1);
+
+    ecs_set_order_by(world, Dummy, Position, NULL);
+    ecs_set(world, e_2, Position, {3, 0});
+
+    /* Table is not sorted again */
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 2);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_1);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_query() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    EcsQuery *q = ecs_query_new(world, "Position");
+    ecs_query_order_by(world, q, Position, compare_position);
+
+    EcsEntity e_1 = ecs_set(world, 0, Position, {3, 0});
+    EcsEntity e_2 = ecs_set(world, 0, Position, {1, 0});
+    EcsEntity e_3 = ecs_set(world, 0, Position, {2, 0});
+    ecs_add(world, e_3, Velocity);
+
+    EcsEntity expect[] = {e_2, e_3, e_1};
+    uint32_t count = 0;
+
+    EcsQueryIter it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_column(&it.rows, Position, 1);
+        int i;
+        for (i = it.rows.begin; i < it.rows.end; i ++) {
+            test_assert(count < 3);
+            test_int(it.rows.entities[i], expect[count]);
+            test_int(p[i].x, count + 1);
+            count ++;
+        }
+    }
+
+    test_int(count, 3);
+
+    ecs_query_free(world, q);
+
+    ecs_fini(world);
+}
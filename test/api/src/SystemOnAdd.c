@@ -641,3 +641,105 @@ void SystemOnAdd_new_w_count_match_1_of_1() {
 
     ecs_fini(world);
 }
+
+void SystemOnAdd_new_match_system_created_after_type() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_new(world, Position);
+    test_int(ctx.count, 0);
+
+    ECS_SYSTEM(world, Init, EcsOnAdd, Position);
+
+    EcsEntity e = ecs_new(world, Position);
+    test_assert(e != 0);
+
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.system, Init);
+    test_int(ctx.e[0], e);
+
+    Position *p = ecs_get_ptr(world, e, Position);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+static
+void Init_2(EcsRows *rows) {
+    Velocity *v = ecs_column(rows, Velocity, 2);
+    Position *p = ecs_column(rows, Position, 1);
+
+    ProbeSystem(rows);
+
+    /* Init runs first, as it was created first */
+    int i;
+    for (i = rows->begin; i < rows->end; i ++) {
+        test_int(p[i].x, 10);
+        v[i].x = p[i].x * 2;
+        v[i].y = p[i].y * 2;
+    }
+}
+
+void SystemOnAdd_add_match_2_systems_in_order() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+    ECS_SYSTEM(world, Init, EcsOnAdd, Position);
+    ECS_SYSTEM(world, Init_2, EcsOnAdd, Position, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    EcsEntity e = ecs_new(world, 0);
+    ecs_add(world, e, Type);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+    test_int(ctx.system, Init_2);
+
+    Velocity *v = ecs_get_ptr(world, e, Velocity);
+    test_int(v->x, 20);
+    test_int(v->y, 40);
+
+    ecs_fini(world);
+}
+
+void SystemOnAdd_add_match_2_systems_on_recycled_handle() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    /* The first system is created on a recycled handle, which has a larger
+     * value than the fresh handle of the second system */
+    ecs_delete(world, ecs_new(world, 0));
+
+    ECS_SYSTEM(world, Init, EcsOnAdd, Position);
+    ECS_SYSTEM(world, Init_2, EcsOnAdd, Position, Velocity);
+    test_assert(Init > Init_2);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    EcsEntity e = ecs_new(world, 0);
+    ecs_add(world, e, Type);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+    test_int(ctx.system, Init_2);
+
+    Velocity *v = ecs_get_ptr(world, e, Velocity);
+    test_int(v->x, 20);
+    test_int(v->y, 40);
+
+    ecs_fini(world);
+}
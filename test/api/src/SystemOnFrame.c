@@ -1238,4 +1238,364 @@ void SystemOnFrame_ensure_optional_is_null_field_shared() {
     test_int(ctx.e[0], e);
 
     ecs_fini(world);
-}
\ No newline at end of file
+}
+static void Dummy_3(EcsRows *rows) { ProbeSystem(rows); }
+
+void SystemOnFrame_match_table_created_after_systems() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ECS_SYSTEM(world, Dummy_1, EcsOnFrame, Position);
+    ECS_SYSTEM(world, Dummy_2, EcsOnFrame, Position, Velocity);
+    ECS_SYSTEM(world, Dummy_3, EcsOnFrame, Position, Mass);
+
+    ECS_ENTITY(world, e, Position, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+    test_int(ctx.e[0], e);
+    test_int(ctx.e[1], e);
+
+    ecs_fini(world);
+}
+
+void SystemOnFrame_match_prefab_table_created_after_system() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, Dummy_1, EcsOnFrame, Velocity);
+    ECS_SYSTEM(world, Dummy_2, EcsOnFrame, Position, Velocity);
+
+    ECS_PREFAB(world, Prefab, Velocity);
+    ECS_ENTITY(world, e, Prefab, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+    test_int(ctx.e[0], e);
+    test_int(ctx.e[1], e);
+
+    ecs_fini(world);
+}
+
+void SystemOnFrame_reactivate_tables_out_of_order() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ECS_SYSTEM(world, Iter, EcsOnFrame, Position);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+    ECS_ENTITY(world, e_3, Position, Mass);
+
+    ecs_delete(world, e_1);
+    ecs_delete(world, e_2);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_3);
+
+    EcsEntity e_4 = ecs_new(world, Position);
+    test_assert(e_4 != 0);
+    ecs_add(world, e_4, Velocity);
+    ecs_delete(world, e_3);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_4);
+
+    EcsEntity e_5 = ecs_new(world, Position);
+    test_assert(e_5 != 0);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+
+    ecs_fini(world);
+}
+
+void SystemOnFrame_system_order_after_reactivation() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ECS_SYSTEM(world, Dummy_1, EcsOnFrame, Position);
+    ECS_SYSTEM(world, Dummy_2, EcsOnFrame, Velocity);
+    ECS_SYSTEM(world, Dummy_3, EcsOnFrame, Mass);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Velocity);
+    ECS_ENTITY(world, e_3, Mass);
+
+    ecs_delete(world, e_1);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_3);
+
+    EcsEntity e_4 = ecs_new(world, Position);
+    test_assert(e_4 != 0);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 3);
+    test_int(ctx.invoked, 3);
+    test_int(ctx.system, Dummy_3);
+    test_int(ctx.e[0], e_4);
+    test_int(ctx.e[1], e_2);
+    test_int(ctx.e[2], e_3);
+
+    ecs_fini(world);
+}
+
+static bool position_changed;
+
+static
+void CheckChanged(EcsRows *rows) {
+    ProbeSystem(rows);
+    position_changed = ecs_column_changed(rows, 1);
+}
+
+static
+void SetPosition(EcsRows *rows) {
+    EcsType TPosition = ecs_column_type(rows, 2);
+    int i;
+    for (i = rows->begin; i < rows->end; i ++) {
+        ecs_set(rows->world, rows->entities[i], Position, {1, 2});
+    }
+}
+
+static void Noop(EcsRows *rows) { }
+
+void SystemOnFrame_column_changed_after_set() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, CheckChanged, EcsOnFrame, [in] Position);
+
+    EcsEntity e = ecs_new(world, Position);
+    test_assert(e != 0);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 1);
+    test_assert(position_changed == true);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 2);
+    test_assert(position_changed == false);
+
+    ecs_set(world, e, Position, {10, 20});
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 3);
+    test_assert(position_changed == true);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 4);
+    test_assert(position_changed == false);
+
+    ecs_fini(world);
+}
+
+void SystemOnFrame_skip_unchanged_table() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, Dummy_1, EcsOnFrame, [in] Position);
+    ecs_set_skip_unchanged(world, Dummy_1, true);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    ecs_set(world, e_2, Position, {10, 20});
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_2);
+
+    ecs_fini(world);
+}
+
+void SystemOnFrame_skip_unchanged_written_by_system() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, Noop, EcsOnFrame, Position, [in] Velocity);
+    ECS_SYSTEM(world, Dummy_1, EcsOnFrame, [in] Position);
+    ecs_set_skip_unchanged(world, Dummy_1, true);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+
+    /* Noop writes Position of e_2 every frame */
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_2);
+
+    ecs_fini(world);
+}
+
+void SystemOnFrame_skip_unchanged_read_by_system() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, Noop, EcsOnFrame, [in] Position, Velocity);
+    ECS_SYSTEM(world, Dummy_1, EcsOnFrame, [in] Position);
+    ecs_set_skip_unchanged(world, Dummy_1, true);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 2);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    ecs_fini(world);
+}
+
+void SystemOnFrame_skip_unchanged_staged_set() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, Dummy_1, EcsOnFrame, [in] Position);
+    ECS_SYSTEM(world, SetPosition, EcsOnFrame, [in] Velocity, [in] Position);
+    ecs_set_skip_unchanged(world, Dummy_1, true);
+
+    ECS_ENTITY(world, e_1, Position);
+    ECS_ENTITY(world, e_2, Position, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+
+    /* Position of e_2 was set while in progress, and merged */
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.e[0], e_2);
+
+    ecs_fini(world);
+}
+
+void SystemOnFrame_system_on_recycled_handle() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    /* The first system is created on a recycled handle, which has a larger
+     * value than the fresh handle of the second system */
+    ecs_delete(world, ecs_new(world, 0));
+
+    ECS_SYSTEM(world, Dummy_1, EcsOnFrame, Position);
+    ECS_SYSTEM(world, Dummy_2, EcsOnFrame, Velocity);
+    test_assert(Dummy_1 > Dummy_2);
+
+    EcsEntity e_1 = ecs_new(world, Velocity);
+    test_assert(e_1 != 0);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.system, Dummy_2);
+    test_int(ctx.e[0], e_1);
+
+    EcsEntity e_2 = ecs_new(world, Position);
+    test_assert(e_2 != 0);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+
+    /* Systems run in the order in which they were created */
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_1);
+    test_int(ctx.system, Dummy_2);
+
+    ecs_fini(world);
+}
@@ -1,5 +1,7 @@
 #include <include/api.h>
 
+static Mass *last_m_ptr;
+
 static
 void Iter(EcsRows *rows) {
     Mass *m_ptr = ecs_shared_test(rows, Mass, 1);
@@ -7,6 +9,7 @@ void Iter(EcsRows *rows) {
     Velocity *v = ecs_column_test(rows, Velocity, 3);
 
     ProbeSystem(rows);
+    last_m_ptr = m_ptr;
 
     Mass m = 1;
     if (m_ptr) {
@@ -62,3 +65,92 @@ void System_w_FromEntity_2_column_1_from_entity() {
 
     ecs_fini(world);
 }
+
+void System_w_FromEntity_2_column_1_from_entity_after_move() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ECS_ENTITY(world, e_1, Mass);
+    ECS_ENTITY(world, e_2, Position);
+
+    ECS_SYSTEM(world, Iter, EcsOnFrame, e_1.Mass, Position);
+
+    ecs_set(world, e_1, Mass, {5});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    Position *p = ecs_get_ptr(world, e_2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 50);
+    test_int(p->y, 100);
+
+    /* Move e_1 to another table, so the resolved reference is stale */
+    ecs_add(world, e_1, Velocity);
+    ecs_set(world, e_1, Mass, {2});
+
+    ecs_progress(world, 1);
+
+    p = ecs_get_ptr(world, e_2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 20);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void System_w_FromEntity_2_column_1_from_entity_after_realloc() {
+    EcsWorld *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Mass);
+
+    ECS_ENTITY(world, e_1, Mass);
+    ECS_ENTITY(world, e_2, Position);
+
+    ECS_SYSTEM(world, Iter, EcsOnFrame, e_1.Mass, Position);
+
+    ecs_set(world, e_1, Mass, {5});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    Position *p = ecs_get_ptr(world, e_2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 50);
+    test_int(p->y, 100);
+
+    /* Grow the table of e_1 one row at a time. The Mass column can be
+     * reallocated while the entity column is grown in place, so check that
+     * the resolved reference is valid after every insert. */
+    EcsType type = ecs_typeid(world, e_1);
+
+    int i;
+    for (i = 0; i < 5000; i ++) {
+        _ecs_new(world, type);
+
+        ctx = (SysTestData){0};
+        ecs_progress(world, 1);
+
+        test_int(ctx.invoked, 1);
+        test_assert(last_m_ptr == ecs_get_ptr(world, e_1, Mass));
+    }
+
+    ecs_set(world, e_1, Mass, {3});
+
+    ecs_progress(world, 1);
+
+    p = ecs_get_ptr(world, e_2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 60);
+
+    ecs_fini(world);
+}
@@ -35,6 +35,11 @@ void New_w_Count_tag(void);
 void New_w_Count_type_w_tag(void);
 void New_w_Count_type_w_2_tags(void);
 void New_w_Count_type_w_tag_mixed(void);
+void New_w_Count_new_w_count_delete(void);
+void New_w_Count_new_w_data(void);
+void New_w_Count_new_w_data_null_buffer(void);
+void New_w_Count_new_w_data_on_set(void);
+void New_w_Count_new_w_data_in_progress(void);
 
 // Testsuite 'Add'
 void Add_zero(void);
@@ -62,6 +67,10 @@ void Add_tag(void);
 void Add_type_w_tag(void);
 void Add_type_w_2_tags(void);
 void Add_type_w_tag_mixed(void);
+void Add_tag_to_entities_in_same_table(void);
+void Add_w_filter(void);
+void Add_w_filter_to_existing_table(void);
+void Add_w_filter_on_add(void);
 
 // Testsuite 'Remove'
 void Remove_zero(void);
@@ -79,6 +88,10 @@ void Remove_type_of_2_of_3(void);
 void Remove_1_from_empty(void);
 void Remove_type_from_empty(void);
 void Remove_not_added(void);
+void Remove_w_filter(void);
+void Remove_w_filter_all(void);
+void Remove_w_filter_on_remove(void);
+void Remove_w_filter_in_progress(void);
 
 // Testsuite 'Has'
 void Has_zero(void);
@@ -99,6 +112,8 @@ void Has_any_of_2_of_1(void);
 void Has_any_of_1_of_0(void);
 void Has_any_2_of_2_disjunct(void);
 void Has_has_in_progress(void);
+void Has_has_high_id(void);
+void Has_any_of_high_id(void);
 
 // Testsuite 'Delete'
 void Delete_delete_1(void);
@@ -109,6 +124,14 @@ void Delete_delete_1st_of_3(void);
 void Delete_delete_2nd_of_3(void);
 void Delete_delete_2_of_3(void);
 void Delete_delete_3_of_3(void);
+void Delete_delete_recycle(void);
+void Delete_delete_empty_recycle(void);
+void Delete_delete_twice_recycle_once(void);
+void Delete_delete_in_progress_recycle(void);
+void Delete_delete_w_filter(void);
+void Delete_delete_w_filter_2_components(void);
+void Delete_delete_w_filter_on_remove(void);
+void Delete_delete_w_filter_in_progress(void);
 
 // Testsuite 'Set'
 void Set_set_empty(void);
@@ -123,6 +146,18 @@ void Set_set_remove(void);
 void Set_set_remove_other(void);
 void Set_set_remove_twice(void);
 void Set_set_and_new(void);
+void Set_set_many_components(void);
+
+// Testsuite 'Ref'
+void Ref_get_ref(void);
+void Ref_get_ref_after_add(void);
+void Ref_get_ref_after_realloc(void);
+void Ref_get_ref_after_many_inserts(void);
+void Ref_get_ref_after_delete_other(void);
+void Ref_get_ref_after_remove(void);
+void Ref_get_ref_other_entity(void);
+void Ref_get_ref_from_prefab(void);
+void Ref_get_ref_in_progress(void);
 
 // Testsuite 'Singleton'
 void Singleton_set(void);
@@ -169,6 +204,9 @@ void SystemOnAdd_clone_match_2_of_3(void);
 void SystemOnAdd_add_again_1(void);
 void SystemOnAdd_set_again_1(void);
 void SystemOnAdd_add_again_2(void);
+void SystemOnAdd_new_match_system_created_after_type(void);
+void SystemOnAdd_add_match_2_systems_in_order(void);
+void SystemOnAdd_add_match_2_systems_on_recycled_handle(void);
 
 // Testsuite 'SystemOnRemove'
 void SystemOnRemove_remove_match_1_of_1(void);
@@ -218,6 +256,16 @@ void SystemOnFrame_ensure_optional_is_null_field_shared(void);
 void SystemOnFrame_use_fields_2_owned(void);
 void SystemOnFrame_use_fields_1_owned_1_shared(void);
 void SystemOnFrame_match_2_systems_w_populated_table(void);
+void SystemOnFrame_match_table_created_after_systems(void);
+void SystemOnFrame_match_prefab_table_created_after_system(void);
+void SystemOnFrame_reactivate_tables_out_of_order(void);
+void SystemOnFrame_system_order_after_reactivation(void);
+void SystemOnFrame_system_on_recycled_handle(void);
+void SystemOnFrame_column_changed_after_set(void);
+void SystemOnFrame_skip_unchanged_table(void);
+void SystemOnFrame_skip_unchanged_written_by_system(void);
+void SystemOnFrame_skip_unchanged_read_by_system(void);
+void SystemOnFrame_skip_unchanged_staged_set(void);
 
 // Testsuite 'SystemManual'
 void SystemManual_1_type_1_component(void);
@@ -251,6 +299,19 @@ void Container_adopt_orphan(void);
 void Container_adopt_2_orphan_1(void);
 void Container_get_ptr_container(void);
 
+// Testsuite 'Lookup'
+void Lookup_lookup(void);
+void Lookup_lookup_component(void);
+void Lookup_lookup_system(void);
+void Lookup_lookup_not_found(void);
+void Lookup_lookup_after_delete(void);
+void Lookup_lookup_after_remove_id(void);
+void Lookup_lookup_after_rename(void);
+void Lookup_lookup_child(void);
+void Lookup_lookup_path(void);
+void Lookup_lookup_path_not_found(void);
+void Lookup_lookup_after_clone(void);
+
 // Testsuite 'Prefab'
 void Prefab_new_w_prefab(void);
 void Prefab_new_w_count_prefab(void);
@@ -273,6 +334,9 @@ void Prefab_match_entity_prefab_w_system_optional(void);
 void Prefab_prefab_in_system_expr(void);
 void Prefab_dont_match_prefab(void);
 void Prefab_new_w_count_w_override(void);
+void Prefab_get_ptr_from_nested_prefab(void);
+void Prefab_override_from_nearest_prefab(void);
+void Prefab_change_type_of_nested_prefab(void);
 
 // Testsuite 'System_w_FromContainer'
 void System_w_FromContainer_1_column_from_container(void);
@@ -298,6 +362,8 @@ void System_w_FromSystem_auto_add_tag(void);
 
 // Testsuite 'System_w_FromEntity'
 void System_w_FromEntity_2_column_1_from_entity(void);
+void System_w_FromEntity_2_column_1_from_entity_after_move(void);
+void System_w_FromEntity_2_column_1_from_entity_after_realloc(void);
 
 // Testsuite 'Run'
 void Run_run(void);
@@ -321,6 +387,41 @@ void Run_run_w_component_filter(void);
 void Run_run_w_type_filter_of_2(void);
 void Run_run_w_container_filter(void);
 
+// Testsuite 'Query'
+void Query_query_1_table(void);
+void Query_query_2_tables(void);
+void Query_query_table_created_after_query(void);
+void Query_query_skip_empty_table(void);
+void Query_query_w_not(void);
+void Query_query_w_shared(void);
+void Query_query_in_system(void);
+void Query_query_free_on_fini(void);
+
+// Testsuite 'Sorting'
+void Sorting_sort_1_table(void);
+void Sorting_sort_2_tables(void);
+void Sorting_sort_after_set(void);
+void Sorting_sort_after_new(void);
+void Sorting_sort_shared(void);
+void Sorting_sort_remove_order(void);
+void Sorting_sort_query(void);
+
+// Testsuite 'Grouping'
+void Grouping_group_by_container(void);
+void Grouping_group_by_after_tables(void);
+void Grouping_group_after_reactivation(void);
+void Grouping_group_w_order_by(void);
+void Grouping_query_skip_group(void);
+
+// Testsuite 'Alignment'
+void Alignment_aligned_columns(void);
+void Alignment_realign_existing_columns(void);
+void Alignment_padded_end(void);
+void Alignment_padded_end_w_limit(void);
+void Alignment_padded_end_wo_width(void);
+void Alignment_jobs_start_aligned(void);
+void Alignment_jobs_start_aligned_w_group_by(void);
+
 // Testsuite 'SingleThreadStaging'
 void SingleThreadStaging_new_empty(void);
 void SingleThreadStaging_new_w_component(void);
@@ -393,6 +494,12 @@ void Internals_activate_table(void);
 void Internals_activate_deactivate_table(void);
 void Internals_activate_deactivate_reactive(void);
 void Internals_activate_deactivate_activate_other(void);
+void Internals_deferred_activate_table(void);
+void Internals_deferred_deactivate_table(void);
+void Internals_deferred_empty_and_fill_table(void);
+void Internals_deferred_deactivation_delay(void);
+void Internals_deferred_deactivate_table_w_threads(void);
+void Internals_add_from_worker_threads(void);
 
 static bake_test_suite suites[] = {
     {
@@ -447,7 +554,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "New_w_Count",
-        .testcase_count = 13,
+        .testcase_count = 18,
         .testcases = (bake_test_case[]){
             {
                 .id = "empty",
@@ -500,12 +607,32 @@ static bake_test_suite suites[] = {
             {
                 .id = "type_w_tag_mixed",
                 .function = New_w_Count_type_w_tag_mixed
+            },
+            {
+                .id = "new_w_count_delete",
+                .function = New_w_Count_new_w_count_delete
+            },
+            {
+                .id = "new_w_data",
+                .function = New_w_Count_new_w_data
+            },
+            {
+                .id = "new_w_data_null_buffer",
+                .function = New_w_Count_new_w_data_null_buffer
+            },
+            {
+                .id = "new_w_data_on_set",
+                .function = New_w_Count_new_w_data_on_set
+            },
+            {
+                .id = "new_w_data_in_progress",
+                .function = New_w_Count_new_w_data_in_progress
             }
         }
     },
     {
         .id = "Add",
-        .testcase_count = 25,
+        .testcase_count = 29,
         .testcases = (bake_test_case[]){
             {
                 .id = "zero",
@@ -606,12 +733,28 @@ static bake_test_suite suites[] = {
             {
                 .id = "type_w_tag_mixed",
                 .function = Add_type_w_tag_mixed
+            },
+            {
+                .id = "tag_to_entities_in_same_table",
+                .function = Add_tag_to_entities_in_same_table
+            },
+            {
+                .id = "w_filter",
+                .function = Add_w_filter
+            },
+            {
+                .id = "w_filter_to_existing_table",
+                .function = Add_w_filter_to_existing_table
+            },
+            {
+                .id = "w_filter_on_add",
+                .function = Add_w_filter_on_add
             }
         }
     },
     {
         .id = "Remove",
-        .testcase_count = 15,
+        .testcase_count = 19,
         .testcases = (bake_test_case[]){
             {
                 .id = "zero",
@@ -672,12 +815,28 @@ static bake_test_suite suites[] = {
             {
                 .id = "not_added",
                 .function = Remove_not_added
+            },
+            {
+                .id = "w_filter",
+                .function = Remove_w_filter
+            },
+            {
+                .id = "w_filter_all",
+                .function = Remove_w_filter_all
+            },
+            {
+                .id = "w_filter_on_remove",
+                .function = Remove_w_filter_on_remove
+            },
+            {
+                .id = "w_filter_in_progress",
+                .function = Remove_w_filter_in_progress
             }
         }
     },
     {
         .id = "Has",
-        .testcase_count = 18,
+        .testcase_count = 20,
         .testcases = (bake_test_case[]){
             {
                 .id = "zero",
@@ -750,12 +909,20 @@ static bake_test_suite suites[] = {
             {
                 .id = "has_in_progress",
                 .function = Has_has_in_progress
+            },
+            {
+                .id = "has_high_id",
+                .function = Has_has_high_id
+            },
+            {
+                .id = "any_of_high_id",
+                .function = Has_any_of_high_id
             }
         }
     },
     {
         .id = "Delete",
-        .testcase_count = 8,
+        .testcase_count = 16,
         .testcases = (bake_test_case[]){
             {
                 .id = "delete_1",
@@ -788,12 +955,44 @@ static bake_test_suite suites[] = {
             {
                 .id = "delete_3_of_3",
                 .function = Delete_delete_3_of_3
+            },
+            {
+                .id = "delete_recycle",
+                .function = Delete_delete_recycle
+            },
+            {
+                .id = "delete_empty_recycle",
+                .function = Delete_delete_empty_recycle
+            },
+            {
+                .id = "delete_twice_recycle_once",
+                .function = Delete_delete_twice_recycle_once
+            },
+            {
+                .id = "delete_in_progress_recycle",
+                .function = Delete_delete_in_progress_recycle
+            },
+            {
+                .id = "delete_w_filter",
+                .function = Delete_delete_w_filter
+            },
+            {
+                .id = "delete_w_filter_2_components",
+                .function = Delete_delete_w_filter_2_components
+            },
+            {
+                .id = "delete_w_filter_on_remove",
+                .function = Delete_delete_w_filter_on_remove
+            },
+            {
+                .id = "delete_w_filter_in_progress",
+                .function = Delete_delete_w_filter_in_progress
             }
         }
     },
     {
         .id = "Set",
-        .testcase_count = 12,
+        .testcase_count = 13,
         .testcases = (bake_test_case[]){
             {
                 .id = "set_empty",
@@ -842,6 +1041,52 @@ static bake_test_suite suites[] = {
             {
                 .id = "set_and_new",
                 .function = Set_set_and_new
+            },
+            {
+                .id = "set_many_components",
+                .function = Set_set_many_components
+            }
+        }
+    },
+    {
+        .id = "Ref",
+        .testcase_count = 9,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "get_ref",
+                .function = Ref_get_ref
+            },
+            {
+                .id = "get_ref_after_add",
+                .function = Ref_get_ref_after_add
+            },
+            {
+                .id = "get_ref_after_realloc",
+                .function = Ref_get_ref_after_realloc
+            },
+            {
+                .id = "get_ref_after_many_inserts",
+                .function = Ref_get_ref_after_many_inserts
+            },
+            {
+                .id = "get_ref_after_delete_other",
+                .function = Ref_get_ref_after_delete_other
+            },
+            {
+                .id = "get_ref_after_remove",
+                .function = Ref_get_ref_after_remove
+            },
+            {
+                .id = "get_ref_other_entity",
+                .function = Ref_get_ref_other_entity
+            },
+            {
+                .id = "get_ref_from_prefab",
+                .function = Ref_get_ref_from_prefab
+            },
+            {
+                .id = "get_ref_in_progress",
+                .function = Ref_get_ref_in_progress
             }
         }
     },
@@ -931,7 +1176,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "SystemOnAdd",
-        .testcase_count = 22,
+        .testcase_count = 25,
         .testcases = (bake_test_case[]){
             {
                 .id = "new_match_1_of_1",
@@ -1020,6 +1265,18 @@ static bake_test_suite suites[] = {
             {
                 .id = "add_again_2",
                 .function = SystemOnAdd_add_again_2
+            },
+            {
+                .id = "new_match_system_created_after_type",
+                .function = SystemOnAdd_new_match_system_created_after_type
+            },
+            {
+                .id = "add_match_2_systems_in_order",
+                .function = SystemOnAdd_add_match_2_systems_in_order
+            },
+            {
+                .id = "add_match_2_systems_on_recycled_handle",
+                .function = SystemOnAdd_add_match_2_systems_on_recycled_handle
             }
         }
     },
@@ -1121,7 +1378,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "SystemOnFrame",
-        .testcase_count = 22,
+        .testcase_count = 32,
         .testcases = (bake_test_case[]){
             {
                 .id = "1_type_1_component",
@@ -1210,6 +1467,46 @@ static bake_test_suite suites[] = {
             {
                 .id = "match_2_systems_w_populated_table",
                 .function = SystemOnFrame_match_2_systems_w_populated_table
+            },
+            {
+                .id = "match_table_created_after_systems",
+                .function = SystemOnFrame_match_table_created_after_systems
+            },
+            {
+                .id = "match_prefab_table_created_after_system",
+                .function = SystemOnFrame_match_prefab_table_created_after_system
+            },
+            {
+                .id = "reactivate_tables_out_of_order",
+                .function = SystemOnFrame_reactivate_tables_out_of_order
+            },
+            {
+                .id = "system_order_after_reactivation",
+                .function = SystemOnFrame_system_order_after_reactivation
+            },
+            {
+                .id = "system_on_recycled_handle",
+                .function = SystemOnFrame_system_on_recycled_handle
+            },
+            {
+                .id = "column_changed_after_set",
+                .function = SystemOnFrame_column_changed_after_set
+            },
+            {
+                .id = "skip_unchanged_table",
+                .function = SystemOnFrame_skip_unchanged_table
+            },
+            {
+                .id = "skip_unchanged_written_by_system",
+                .function = SystemOnFrame_skip_unchanged_written_by_system
+            },
+            {
+                .id = "skip_unchanged_read_by_system",
+                .function = SystemOnFrame_skip_unchanged_read_by_system
+            },
+            {
+                .id = "skip_unchanged_staged_set",
+                .function = SystemOnFrame_skip_unchanged_staged_set
             }
         }
     },
@@ -1335,9 +1632,59 @@ static bake_test_suite suites[] = {
             }
         }
     },
+    {
+        .id = "Lookup",
+        .testcase_count = 11,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "lookup",
+                .function = Lookup_lookup
+            },
+            {
+                .id = "lookup_component",
+                .function = Lookup_lookup_component
+            },
+            {
+                .id = "lookup_system",
+                .function = Lookup_lookup_system
+            },
+            {
+                .id = "lookup_not_found",
+                .function = Lookup_lookup_not_found
+            },
+            {
+                .id = "lookup_after_delete",
+                .function = Lookup_lookup_after_delete
+            },
+            {
+                .id = "lookup_after_remove_id",
+                .function = Lookup_lookup_after_remove_id
+            },
+            {
+                .id = "lookup_after_rename",
+                .function = Lookup_lookup_after_rename
+            },
+            {
+                .id = "lookup_child",
+                .function = Lookup_lookup_child
+            },
+            {
+                .id = "lookup_path",
+                .function = Lookup_lookup_path
+            },
+            {
+                .id = "lookup_path_not_found",
+                .function = Lookup_lookup_path_not_found
+            },
+            {
+                .id = "lookup_after_clone",
+                .function = Lookup_lookup_after_clone
+            }
+        }
+    },
     {
         .id = "Prefab",
-        .testcase_count = 21,
+        .testcase_count = 24,
         .testcases = (bake_test_case[]){
             {
                 .id = "new_w_prefab",
@@ -1422,6 +1769,18 @@ static bake_test_suite suites[] = {
             {
                 .id = "new_w_count_w_override",
                 .function = Prefab_new_w_count_w_override
+            },
+            {
+                .id = "get_ptr_from_nested_prefab",
+                .function = Prefab_get_ptr_from_nested_prefab
+            },
+            {
+                .id = "override_from_nearest_prefab",
+                .function = Prefab_override_from_nearest_prefab
+            },
+            {
+                .id = "change_type_of_nested_prefab",
+                .function = Prefab_change_type_of_nested_prefab
             }
         }
     },
@@ -1509,11 +1868,19 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "System_w_FromEntity",
-        .testcase_count = 1,
+        .testcase_count = 3,
         .testcases = (bake_test_case[]){
             {
                 .id = "2_column_1_from_entity",
                 .function = System_w_FromEntity_2_column_1_from_entity
+            },
+            {
+                .id = "2_column_1_from_entity_after_move",
+                .function = System_w_FromEntity_2_column_1_from_entity_after_move
+            },
+            {
+                .id = "2_column_1_from_entity_after_realloc",
+                .function = System_w_FromEntity_2_column_1_from_entity_after_realloc
             }
         }
     },
@@ -1603,6 +1970,138 @@ static bake_test_suite suites[] = {
             }
         }
     },
+    {
+        .id = "Query",
+        .testcase_count = 8,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "query_1_table",
+                .function = Query_query_1_table
+            },
+            {
+                .id = "query_2_tables",
+                .function = Query_query_2_tables
+            },
+            {
+                .id = "query_table_created_after_query",
+                .function = Query_query_table_created_after_query
+            },
+            {
+                .id = "query_skip_empty_table",
+                .function = Query_query_skip_empty_table
+            },
+            {
+                .id = "query_w_not",
+                .function = Query_query_w_not
+            },
+            {
+                .id = "query_w_shared",
+                .function = Query_query_w_shared
+            },
+            {
+                .id = "query_in_system",
+                .function = Query_query_in_system
+            },
+            {
+                .id = "query_free_on_fini",
+                .function = Query_query_free_on_fini
+            }
+        }
+    },
+    {
+        .id = "Sorting",
+        .testcase_count = 7,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "sort_1_table",
+                .function = Sorting_sort_1_table
+            },
+            {
+                .id = "sort_2_tables",
+                .function = Sorting_sort_2_tables
+            },
+            {
+                .id = "sort_after_set",
+                .function = Sorting_sort_after_set
+            },
+            {
+                .id = "sort_after_new",
+                .function = Sorting_sort_after_new
+            },
+            {
+                .id = "sort_shared",
+                .function = Sorting_sort_shared
+            },
+            {
+                .id = "sort_remove_order",
+                .function = Sorting_sort_remove_order
+            },
+            {
+                .id = "sort_query",
+                .function = Sorting_sort_query
+            }
+        }
+    },
+    {
+        .id = "Grouping",
+        .testcase_count = 5,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "group_by_container",
+                .function = Grouping_group_by_container
+            },
+            {
+                .id = "group_by_after_tables",
+                .function = Grouping_group_by_after_tables
+            },
+            {
+                .id = "group_after_reactivation",
+                .function = Grouping_group_after_reactivation
+            },
+            {
+                .id = "group_w_order_by",
+                .function = Grouping_group_w_order_by
+            },
+            {
+                .id = "query_skip_group",
+                .function = Grouping_query_skip_group
+            }
+        }
+    },
+    {
+        .id = "Alignment",
+        .testcase_count = 7,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "aligned_columns",
+                .function = Alignment_aligned_columns
+            },
+            {
+                .id = "realign_existing_columns",
+                .function = Alignment_realign_existing_columns
+            },
+            {
+                .id = "padded_end",
+                .function = Alignment_padded_end
+            },
+            {
+                .id = "padded_end_w_limit",
+                .function = Alignment_padded_end_w_limit
+            },
+            {
+                .id = "padded_end_wo_width",
+                .function = Alignment_padded_end_wo_width
+            },
+            {
+                .id = "jobs_start_aligned",
+                .function = Alignment_jobs_start_aligned
+            },
+            {
+                .id = "jobs_start_aligned_w_group_by",
+                .function = Alignment_jobs_start_aligned_w_group_by
+            }
+        }
+    },
     {
         .id = "SingleThreadStaging",
         .testcase_count = 58,
@@ -1865,7 +2364,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "Internals",
-        .testcase_count = 5,
+        .testcase_count = 11,
         .testcases = (bake_test_case[]){
             {
                 .id = "deactivate_table",
@@ -1886,6 +2385,30 @@ static bake_test_suite suites[] = {
             {
                 .id = "activate_deactivate_activate_other",
                 .function = Internals_activate_deactivate_activate_other
+            },
+            {
+                .id = "deferred_activate_table",
+                .function = Internals_deferred_activate_table
+            },
+            {
+                .id = "deferred_deactivate_table",
+                .function = Internals_deferred_deactivate_table
+            },
+            {
+                .id = "deferred_empty_and_fill_table",
+                .function = Internals_deferred_empty_and_fill_table
+            },
+            {
+                .id = "deferred_deactivation_delay",
+                .function = Internals_deferred_deactivation_delay
+            },
+            {
+                .id = "deferred_deactivate_table_w_threads",
+                .function = Internals_deferred_deactivate_table_w_threads
+            },
+            {
+                .id = "add_from_worker_threads",
+                .function = Internals_add_from_worker_threads
             }
         }
     }
@@ -1893,5 +2416,5 @@ static bake_test_suite suites[] = {
 
 int main(int argc, char *argv[]) {
     ut_init(argv[0]);
-    return bake_test_run("api", argc, argv, suites, 25);
+    return bake_test_run("api", argc, argv, suites, 31);
 }
@@ -45,14 +45,14 @@ void Map_set_rehash() {
     EcsMap *map = ecs_map_new(8);
     fill_map(map);
 
-    test_int(ecs_map_bucket_count(map), 10);
+    test_int(ecs_map_bucket_count(map), 16);
 
     int i;
-    for (i = 5; i < 10; i ++) {
+    for (i = 5; i < 20; i ++) {
         ecs_map_set(map, i, "zzz");
     }
 
-    test_int(ecs_map_bucket_count(map), 20);
+    test_int(ecs_map_bucket_count(map), 32);
     test_str(ecs_map_get(map, 1), "hello");
     test_str(ecs_map_get(map, 2), "world");
     test_str(ecs_map_get(map, 3), "foo");
@@ -117,20 +117,24 @@ void Map_iter() {
     EcsMap *map = ecs_map_new(16);
     fill_map(map);
 
-    EcsIter it = ecs_map_iter(map);
-    test_assert(ecs_iter_hasnext(&it) == true);
-    test_str(ecs_iter_next(&it), "hello");
-
-    test_assert(ecs_iter_hasnext(&it) == true);
-    test_str(ecs_iter_next(&it), "world");
+    /* Iteration order is not defined, so test that each element is returned
+     * exactly once */
+    bool found[5] = {false};
+    int count = 0;
 
-    test_assert(ecs_iter_hasnext(&it) == true);
-    test_str(ecs_iter_next(&it), "foo");
-
-    test_assert(ecs_iter_hasnext(&it) == true);
-    test_str(ecs_iter_next(&it), "bar");
+    EcsIter it = ecs_map_iter(map);
+    while (ecs_iter_hasnext(&it)) {
+        uint64_t key;
+        char *value = (char*)(uintptr_t)ecs_map_next(&it, &key);
+        test_assert(key >= 1 && key <= 4);
+        test_assert(!found[key]);
+        test_str(value, elems[key - 1].value);
+        found[key] = true;
+        count ++;
+    }
 
-    test_assert(ecs_iter_hasnext(&it) == false);
+    test_int(count, 4);
+    ecs_map_free(map);
 }
 
 void Map_iter_empty() {
@@ -174,3 +178,99 @@ void Map_remove_unknown() {
     test_int(ecs_map_count(map), 4);
     ecs_map_free(map);
 }
+
+void Map_remove_reinsert() {
+    EcsMap *map = ecs_map_new(0);
+
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_map_set64(map, i + 1, i);
+    }
+
+    for (i = 0; i < 1000; i += 2) {
+        test_assert(ecs_map_remove(map, i + 1) == EcsOk);
+    }
+
+    test_int(ecs_map_count(map), 500);
+
+    for (i = 0; i < 1000; i ++) {
+        test_assert(ecs_map_has(map, i + 1, NULL) == (i % 2 == 1));
+    }
+
+    for (i = 0; i < 1000; i += 2) {
+        ecs_map_set64(map, i + 1, i);
+    }
+
+    test_int(ecs_map_count(map), 1000);
+
+    for (i = 0; i < 1000; i ++) {
+        test_int(ecs_map_get64(map, i + 1), i);
+    }
+
+    ecs_map_free(map);
+}
+
+void Map_set_key_zero() {
+    EcsMap *map = ecs_map_new(16);
+    ecs_map_set(map, 0, "hello");
+    test_int(ecs_map_count(map), 1);
+    test_str(ecs_map_get(map, 0), "hello");
+    test_assert(ecs_map_remove(map, 0) == EcsOk);
+    test_int(ecs_map_count(map), 0);
+    test_assert(ecs_map_get(map, 0) == NULL);
+    ecs_map_free(map);
+}
+
+void Map_set_many() {
+    EcsMap *map = ecs_map_new(0);
+
+    int i;
+    for (i = 0; i < 100000; i ++) {
+        ecs_map_set64(map, (uint64_t)i << 32, i);
+    }
+
+    test_int(ecs_map_count(map), 100000);
+
+    for (i = 0; i < 100000; i ++) {
+        test_int(ecs_map_get64(map, (uint64_t)i << 32), i);
+    }
+
+    ecs_map_free(map);
+}
+
+void Map_clear() {
+    EcsMap *map = ecs_map_new(16);
+    fill_map(map);
+    ecs_map_clear(map);
+    test_int(ecs_map_count(map), 0);
+    test_assert(ecs_map_get(map, 1) == NULL);
+
+    EcsIter it = ecs_map_iter(map);
+    test_assert(!ecs_iter_hasnext(&it));
+
+    ecs_map_free(map);
+}
+
+void Map_clear_reuse() {
+    EcsMap *map = ecs_map_new(0);
+
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_map_set64(map, i + 1, i);
+    }
+
+    uint32_t bucket_count = ecs_map_bucket_count(map);
+    ecs_map_clear(map);
+
+    /* Clearing a map should not release its buckets */
+    test_int(ecs_map_bucket_count(map), bucket_count);
+
+    for (i = 0; i < 1000; i ++) {
+        ecs_map_set64(map, i + 1, i);
+    }
+
+    test_int(ecs_map_bucket_count(map), bucket_count);
+    test_int(ecs_map_count(map), 1000);
+
+    ecs_map_free(map);
+}
@@ -0,0 +1,713 @@
+#include <include/collections.h>
+#include "../../include/private/types.h"
+
+/* Benchmarks that compare the map implementation against the chained hash map
+ * it replaced. The chained map is kept here only as a reference point. Each
+ * benchmark also verifies that both maps return the same results. */
+
+#define BENCH_COUNT (100000)
+
+/* -- Chained hash map (previous implementation) -- */
+
+typedef struct ChainedMap ChainedMap;
+
+typedef struct ChainedMapIter {
+    uint32_t bucket_index;
+    uint32_t node;
+} ChainedMapIter;
+
+#define CHAINED_LOAD_FACTOR (3.0f / 4.0f)
+
+typedef struct ChainedMapNode {
+    uint64_t key;           /* Key */
+    uint64_t data;          /* Value */
+    uint32_t next;          /* Next node index */
+    uint32_t prev;          /* Previous node index (enables O(1) removal) */
+} ChainedMapNode;
+
+struct ChainedMap {
+    uint32_t *buckets;      /* Array of buckets */
+    EcsArray *nodes;        /* Array with memory for map nodes */
+    size_t bucket_count;    /* number of buckets */
+    uint32_t count;         /* number of elements */
+    uint32_t min;           /* minimum number of elements */
+};
+
+static
+void move_node(
+    EcsArray *array,
+    const EcsArrayParams *params,
+    void *to,
+    void *from,
+    void *ctx);
+
+static
+const EcsArrayParams node_arr_params = {
+    .element_size = sizeof(ChainedMapNode),
+    .move_action = move_node
+};
+
+/** Get map node from index */
+static
+ChainedMapNode *node_from_index(
+    EcsArray *nodes,
+    uint32_t index)
+{
+    return ecs_array_get(nodes, &node_arr_params, index - 1);
+}
+
+/** Get a bucket for a given key */
+static
+uint32_t* get_bucket(
+    ChainedMap *map,
+    uint64_t key)
+{
+    uint64_t index = key % map->bucket_count;
+    return &map->buckets[index];
+}
+
+/** Callback that updates administration when node is moved in nodes array */
+static
+void move_node(
+    EcsArray *array,
+    const EcsArrayParams *params,
+    void *to,
+    void *from,
+    void *ctx)
+{
+    ChainedMapNode *node_p = to;
+    uint32_t node = ecs_array_get_index(array, &node_arr_params, to) + 1;
+    uint32_t prev = node_p->prev;
+    uint32_t next = node_p->next;
+
+    if (prev) {
+        ChainedMapNode *prev_p = node_from_index(array, prev);
+        prev_p->next = node;
+    } else {
+        ChainedMap *map = ctx;
+        uint32_t *bucket = get_bucket(map, node_p->key);
+        *bucket = node;
+    }
+
+    if (next) {
+        ChainedMapNode *next_p = node_from_index(array, next);
+        next_p->prev = node;
+    }
+}
+
+/** Allocate the buckets buffer */
+static
+void alloc_buffer(
+    ChainedMap *map,
+    uint32_t bucket_count)
+{
+    if (bucket_count) {
+        map->buckets = calloc(bucket_count * sizeof(uint32_t), 1);
+        ecs_assert(map->buckets != NULL, ECS_OUT_OF_MEMORY, 0);
+    } else {
+        map->buckets = NULL;
+    }
+
+    map->bucket_count = bucket_count;
+}
+
+/** Allocate a map object */
+static
+ChainedMap *alloc_map(
+    uint32_t bucket_count)
+{
+    ChainedMap *result = malloc(sizeof(ChainedMap));
+    alloc_buffer(result, bucket_count);
+    result->count = 0;
+    result->min = bucket_count;
+    result->nodes = ecs_array_new(&node_arr_params, ECS_MAP_INITIAL_NODE_COUNT);
+    return result;
+}
+
+/** Find next non-empty bucket */
+static
+uint32_t next_bucket(
+    ChainedMap *map,
+    uint32_t start_index)
+{
+    int i;
+    for (i = start_index; i < map->bucket_count; i ++) {
+        if (map->buckets[i]) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/** Add new node to bucket */
+static
+void add_node(
+    ChainedMap *map,
+    uint32_t *bucket,
+    uint64_t key,
+    uint64_t data,
+    ChainedMapNode *elem_p)
+{
+    uint32_t elem;
+
+    if (!elem_p) {
+        elem_p = ecs_array_add(&map->nodes, &node_arr_params);
+        elem = ecs_array_count(map->nodes);
+    } else {
+        elem = ecs_array_get_index(
+            map->nodes,
+            &node_arr_params,
+            elem_p) + 1;
+    }
+
+    elem_p->key = key;
+    elem_p->data = data;
+    elem_p->next = 0;
+    elem_p->prev = 0;
+
+    uint32_t first = *bucket;
+    if (first) {
+        ChainedMapNode *first_p = node_from_index(map->nodes, first);
+        first_p->prev = elem;
+        elem_p->next = first;
+    }
+
+    *bucket = elem;
+
+    map->count ++;
+}
+
+/** Get map node for a given key */
+static
+ChainedMapNode *get_node(
+    ChainedMap *map,
+    uint32_t *bucket,
+    uint64_t key)
+{
+    uint32_t node = *bucket;
+
+    while (node) {
+        ChainedMapNode *node_p = node_from_index(map->nodes, node);
+
+        if (node_p->prev) {
+            assert(node_from_index(map->nodes, node_p->prev)->next == node);
+        }
+        if (node_p->next) {
+            assert(node_from_index(map->nodes, node_p->next)->prev == node);
+        }
+
+        if (node_p->key == key) {
+            return node_p;
+        }
+        node = node_p->next;
+    }
+
+    return NULL;
+}
+
+/** Iterator hasnext callback */
+static
+bool hasnext(
+    EcsIter *iter)
+{
+    ChainedMap *map = iter->data;
+
+    if (!map->count) {
+        return false;
+    }
+
+    if (!map->buckets) {
+        return false;
+    }
+
+    ChainedMapIter *iter_data = iter->ctx;
+    uint32_t bucket_index = iter_data->bucket_index;
+    uint32_t node = iter_data->node;
+
+    if (node) {
+        ChainedMapNode *node_p = node_from_index(map->nodes, node);
+        node = node_p->next;
+    }
+
+    if (!node) {
+        bucket_index = next_bucket(map, bucket_index + 1);
+        if (bucket_index < map->bucket_count) {
+            node = map->buckets[bucket_index];
+        } else {
+            node = 0;
+        }
+    }
+
+    if (node) {
+        iter_data->node = node;
+        iter_data->bucket_index = bucket_index;
+        return true;
+    } else {
+        return false;
+    }
+}
+
+/** Map-specific next functionality that returns keys and 64bit data */
+static
+uint64_t next_w_key(
+    EcsIter *iter,
+    uint64_t *key_out)
+{
+    ChainedMap *map = iter->data;
+    ChainedMapIter *iter_data = iter->ctx;
+    ChainedMapNode *node_p = node_from_index(map->nodes, iter_data->node);
+    assert(node_p != NULL);
+    if (key_out) *key_out = node_p->key;
+    return node_p->data;
+}
+
+/** Iterator next callback */
+static
+void *next(
+    EcsIter *iter)
+{
+    return (void*)next_w_key(iter, NULL);
+}
+
+/** Resize number of buckets in a map */
+static
+void resize_map(
+    ChainedMap *map,
+    uint32_t bucket_count)
+{
+    uint32_t *old_buckets = map->buckets;
+    uint32_t old_bucket_count = map->bucket_count;
+
+    alloc_buffer(map, bucket_count);
+    map->count = 0;
+
+    uint32_t bucket_index;
+    for (bucket_index = 0; bucket_index < old_bucket_count; bucket_index ++) {
+        uint32_t bucket = old_buckets[bucket_index];
+        if (bucket) {
+            uint32_t node = bucket;
+            uint32_t next;
+            uint64_t key;
+
+            ChainedMapNode *node_p;
+            do {
+                node_p = node_from_index(map->nodes, node);
+                next = node_p->next;
+                key = node_p->key;
+                uint32_t *new_bucket = get_bucket(map, key);
+                add_node(map, new_bucket, key, node_p->data, node_p);
+            } while ((node = next));
+        }
+    }
+
+    free(old_buckets);
+}
+
+
+static
+ChainedMap* chained_map_new(
+    uint32_t size)
+{
+    return alloc_map((float)size / CHAINED_LOAD_FACTOR);
+}
+
+static
+void chained_map_clear(
+    ChainedMap *map)
+{
+    uint32_t target_size = (float)map->count / CHAINED_LOAD_FACTOR;
+
+    if (target_size < map->min) {
+        target_size = map->min;
+    }
+
+    if (target_size < (float)map->bucket_count * 0.75) {
+        free(map->buckets);
+        alloc_buffer(map, target_size);
+    } else {
+        int i;
+        for (i = 0; i < map->bucket_count; i ++) {
+            map->buckets[i] = 0;
+        }
+    }
+
+    ecs_array_reclaim(&map->nodes, &node_arr_params);
+    ecs_array_clear(map->nodes);
+
+    map->count = 0;
+}
+
+static
+void chained_map_free(
+    ChainedMap *map)
+{
+    ecs_array_free(map->nodes);
+    free(map->buckets);
+    free(map);
+}
+
+static
+void chained_map_set64(
+    ChainedMap *map,
+    uint64_t key,
+    uint64_t data)
+{
+    uint32_t bucket_count = map->bucket_count;
+    if (!bucket_count) {
+        alloc_buffer(map, 2);
+        bucket_count = map->bucket_count;
+    }
+
+    uint32_t *bucket = get_bucket(map, key);
+
+    if (!*bucket) {
+        add_node(map, bucket, key, data, NULL);
+    } else {
+        ChainedMapNode *elem = get_node(map, bucket, key);
+        if (elem) {
+            elem->data = data;
+        } else {
+            add_node(map, bucket, key, data, NULL);
+        }
+    }
+
+    if ((float)map->count / (float)bucket_count > CHAINED_LOAD_FACTOR) {
+        resize_map(map, bucket_count * 2);
+    }
+}
+
+static
+EcsResult chained_map_remove(
+    ChainedMap *map,
+    uint64_t key)
+{
+    if (!map->count) {
+        return EcsError;
+    }
+
+    uint32_t *bucket = get_bucket(map, key);
+
+    if (*bucket) {
+        ChainedMapNode *node = get_node(map, bucket, key);
+        if (node) {
+            ChainedMapNode *prev_node = node_from_index(map->nodes, node->prev);
+            ChainedMapNode *next_node = node_from_index(map->nodes, node->next);
+
+            if (prev_node) {
+                assert(node_from_index(map->nodes, prev_node->next) == node);
+                prev_node->next = node->next;
+            } else {
+                *bucket = node->next;
+            }
+
+            if (next_node) {
+                assert(node_from_index(map->nodes, next_node->prev) == node);
+                next_node->prev = node->prev;
+            }
+
+            EcsArrayParams params = node_arr_params;
+            params.move_ctx = map;
+
+            ecs_array_remove(map->nodes, &params, node);
+            map->count --;
+
+            return EcsOk;
+        }
+    }
+
+    return EcsError;
+}
+
+static
+uint64_t chained_map_get64(
+    ChainedMap *map,
+    uint64_t key)
+{
+    if (!map->count) {
+        return 0;
+    }
+
+    uint32_t *bucket = get_bucket(map, key);
+    if (*bucket) {
+        ChainedMapNode *elem = get_node(map, bucket, key);
+        if (elem) {
+            return elem->data;
+        }
+    }
+
+    return 0;
+}
+
+static
+uint32_t chained_map_count(
+    ChainedMap *map)
+{
+    return map->count;
+}
+
+static
+EcsIter chained_map_iter(
+    ChainedMap *map,
+    ChainedMapIter *iter_data)
+{
+    EcsIter result = {
+        .data = map,
+        .ctx = iter_data,
+        .hasnext = hasnext,
+        .next = next,
+        .release = NULL
+    };
+
+    iter_data->bucket_index = -1;
+    iter_data->node = 0;
+
+    return result;
+}
+
+static
+uint64_t chained_map_next(
+    EcsIter *it,
+    uint64_t *key_out)
+{
+    return next_w_key(it, key_out);
+}
+
+
+/* -- Benchmarks -- */
+
+static
+void report(
+    const char *bench,
+    double chained_time,
+    double map_time)
+{
+    printf("    %s: chained %.2fms, open addressing %.2fms (%.1fx)\n", 
+        bench, chained_time * 1000, map_time * 1000, 
+        chained_time / map_time);
+}
+
+/** Generate keys that look like entity ids (sequential), random 64bit keys
+ * and keys that are multiples of a large power of two */
+static
+uint64_t* gen_keys(
+    int kind)
+{
+    uint64_t *keys = malloc(BENCH_COUNT * sizeof(uint64_t));
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    int i;
+
+    for (i = 0; i < BENCH_COUNT; i ++) {
+        if (kind == 0) {
+            keys[i] = 1000 + i;
+        } else if (kind == 1) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            keys[i] = seed;
+        } else {
+            keys[i] = (uint64_t)(i + 1) << 12;
+        }
+    }
+
+    return keys;
+}
+
+static
+void bench_set_get(
+    const char *bench,
+    int kind,
+    int count)
+{
+    uint64_t *keys = gen_keys(kind);
+    ChainedMap *chained = chained_map_new(0);
+    EcsMap *map = ecs_map_new(0);
+    struct timespec start;
+    double chained_time, map_time;
+    int i;
+
+    ut_time_get(&start);
+    for (i = 0; i < count; i ++) {
+        chained_map_set64(chained, keys[i], i + 1);
+    }
+    for (i = 0; i < count; i ++) {
+        test_assert(chained_map_get64(chained, keys[i]) == i + 1);
+    }
+    chained_time = ut_time_measure(&start);
+
+    ut_time_get(&start);
+    for (i = 0; i < count; i ++) {
+        ecs_map_set64(map, keys[i], i + 1);
+    }
+    for (i = 0; i < count; i ++) {
+        test_assert(ecs_map_get64(map, keys[i]) == i + 1);
+    }
+    map_time = ut_time_measure(&start);
+
+    test_int(ecs_map_count(map), chained_map_count(chained));
+    report(bench, chained_time, map_time);
+
+    chained_map_free(chained);
+    ecs_map_free(map);
+    free(keys);
+}
+
+void MapBench_set_get_sequential() {
+    bench_set_get("set_get_sequential", 0, BENCH_COUNT);
+}
+
+void MapBench_set_get_random() {
+    bench_set_get("set_get_random", 1, BENCH_COUNT);
+}
+
+void MapBench_set_get_stride() {
+    /* Keys collide in the chained map, so use fewer keys to keep the runtime
+     * of the benchmark reasonable */
+    bench_set_get("set_get_stride", 2, BENCH_COUNT / 50);
+}
+
+void MapBench_get_unknown() {
+    uint64_t *keys = gen_keys(0);
+    ChainedMap *chained = chained_map_new(0);
+    EcsMap *map = ecs_map_new(0);
+    struct timespec start;
+    double chained_time, map_time;
+    int i;
+
+    for (i = 0; i < BENCH_COUNT; i ++) {
+        chained_map_set64(chained, keys[i], i + 1);
+        ecs_map_set64(map, keys[i], i + 1);
+    }
+
+    ut_time_get(&start);
+    for (i = 0; i < BENCH_COUNT; i ++) {
+        test_assert(chained_map_get64(chained, keys[i] + BENCH_COUNT) == 0);
+    }
+    chained_time = ut_time_measure(&start);
+
+    ut_time_get(&start);
+    for (i = 0; i < BENCH_COUNT; i ++) {
+        test_assert(ecs_map_get64(map, keys[i] + BENCH_COUNT) == 0);
+    }
+    map_time = ut_time_measure(&start);
+
+    report("get_unknown", chained_time, map_time);
+
+    chained_map_free(chained);
+    ecs_map_free(map);
+    free(keys);
+}
+
+void MapBench_remove() {
+    uint64_t *keys = gen_keys(1);
+    ChainedMap *chained = chained_map_new(0);
+    EcsMap *map = ecs_map_new(0);
+    struct timespec start;
+    double chained_time, map_time;
+    int i;
+
+    for (i = 0; i < BENCH_COUNT; i ++) {
+        chained_map_set64(chained, keys[i], i + 1);
+        ecs_map_set64(map, keys[i], i + 1);
+    }
+
+    ut_time_get(&start);
+    for (i = 0; i < BENCH_COUNT; i += 2) {
+        test_assert(chained_map_remove(chained, keys[i]) == EcsOk);
+    }
+    for (i = 0; i < BENCH_COUNT; i ++) {
+        chained_map_get64(chained, keys[i]);
+    }
+    chained_time = ut_time_measure(&start);
+
+    ut_time_get(&start);
+    for (i = 0; i < BENCH_COUNT; i += 2) {
+        test_assert(ecs_map_remove(map, keys[i]) == EcsOk);
+    }
+    for (i = 0; i < BENCH_COUNT; i ++) {
+        test_assert(ecs_map_get64(map, keys[i]) == 
+            chained_map_get64(chained, keys[i]));
+    }
+    map_time = ut_time_measure(&start);
+
+    test_int(ecs_map_count(map), chained_map_count(chained));
+    report("remove", chained_time, map_time);
+
+    chained_map_free(chained);
+    ecs_map_free(map);
+    free(keys);
+}
+
+/* Stages fill a map with a small number of elements every frame, and clear it
+ * when the stage is merged */
+void MapBench_clear_fill() {
+    uint64_t *keys = gen_keys(0);
+    ChainedMap *chained = chained_map_new(0);
+    EcsMap *map = ecs_map_new(0);
+    struct timespec start;
+    double chained_time, map_time;
+    int frame, i, frame_count = BENCH_COUNT / 1000;
+
+    ut_time_get(&start);
+    for (frame = 0; frame < frame_count; frame ++) {
+        for (i = 0; i < 1000; i ++) {
+            chained_map_set64(chained, keys[frame * 1000 + i], i + 1);
+        }
+        chained_map_clear(chained);
+    }
+    chained_time = ut_time_measure(&start);
+
+    ut_time_get(&start);
+    for (frame = 0; frame < frame_count; frame ++) {
+        for (i = 0; i < 1000; i ++) {
+            ecs_map_set64(map, keys[frame * 1000 + i], i + 1);
+        }
+        test_int(ecs_map_count(map), 1000);
+        ecs_map_clear(map);
+    }
+    map_time = ut_time_measure(&start);
+
+    test_int(ecs_map_count(map), 0);
+    report("clear_fill", chained_time, map_time);
+
+    chained_map_free(chained);
+    ecs_map_free(map);
+    free(keys);
+}
+
+void MapBench_iter() {
+    uint64_t *keys = gen_keys(0);
+    ChainedMap *chained = chained_map_new(0);
+    EcsMap *map = ecs_map_new(0);
+    struct timespec start;
+    double chained_time, map_time;
+    uint64_t chained_sum = 0, map_sum = 0;
+    int i;
+
+    for (i = 0; i < BENCH_COUNT; i ++) {
+        chained_map_set64(chained, keys[i], i + 1);
+        ecs_map_set64(map, keys[i], i + 1);
+    }
+
+    ut_time_get(&start);
+    EcsIter chained_it = chained_map_iter(
+        chained, alloca(sizeof(ChainedMapIter)));
+    while (ecs_iter_hasnext(&chained_it)) {
+        chained_sum += chained_map_next(&chained_it, NULL);
+    }
+    chained_time = ut_time_measure(&start);
+
+    ut_time_get(&start);
+    EcsIter it = ecs_map_iter(map);
+    while (ecs_iter_hasnext(&it)) {
+        map_sum += ecs_map_next(&it, NULL);
+    }
+    map_time = ut_time_measure(&start);
+
+    test_assert(chained_sum == map_sum);
+    report("iter", chained_time, map_time);
+
+    chained_map_free(chained);
+    ecs_map_free(map);
+    free(keys);
+}
@@ -47,6 +47,20 @@ void Map_iter_zero_buckets(void);
 void Map_remove(void);
 void Map_remove_empty(void);
 void Map_remove_unknown(void);
+void Map_remove_reinsert(void);
+void Map_set_key_zero(void);
+void Map_set_many(void);
+void Map_clear(void);
+void Map_clear_reuse(void);
+
+// Testsuite 'MapBench'
+void MapBench_set_get_sequential(void);
+void MapBench_set_get_random(void);
+void MapBench_set_get_stride(void);
+void MapBench_get_unknown(void);
+void MapBench_remove(void);
+void MapBench_clear_fill(void);
+void MapBench_iter(void);
 
 static bake_test_suite suites[] = {
     {
@@ -141,7 +155,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "Map",
-        .testcase_count = 15,
+        .testcase_count = 20,
         .testcases = (bake_test_case[]){
             {
                 .id = "count",
@@ -202,6 +216,60 @@ static bake_test_suite suites[] = {
             {
                 .id = "remove_unknown",
                 .function = Map_remove_unknown
+            },
+            {
+                .id = "remove_reinsert",
+                .function = Map_remove_reinsert
+            },
+            {
+                .id = "set_key_zero",
+                .function = Map_set_key_zero
+            },
+            {
+                .id = "set_many",
+                .function = Map_set_many
+            },
+            {
+                .id = "clear",
+                .function = Map_clear
+            },
+            {
+                .id = "clear_reuse",
+                .function = Map_clear_reuse
+            }
+        }
+    },
+    {
+        .id = "MapBench",
+        .testcase_count = 7,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "set_get_sequential",
+                .function = MapBench_set_get_sequential
+            },
+            {
+                .id = "set_get_random",
+                .function = MapBench_set_get_random
+            },
+            {
+                .id = "set_get_stride",
+                .function = MapBench_set_get_stride
+            },
+            {
+                .id = "get_unknown",
+                .function = MapBench_get_unknown
+            },
+            {
+                .id = "remove",
+                .function = MapBench_remove
+            },
+            {
+                .id = "clear_fill",
+                .function = MapBench_clear_fill
+            },
+            {
+                .id = "iter",
+                .function = MapBench_iter
             }
         }
     }
@@ -209,5 +277,5 @@ static bake_test_suite suites[] = {
 
 int main(int argc, char *argv[]) {
     ut_init(argv[0]);
-    return bake_test_run("collections", argc, argv, suites, 2);
+    return bake_test_run("collections", argc, argv, suites, 3);
 }